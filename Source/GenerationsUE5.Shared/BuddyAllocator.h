@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Suballocates power of two blocks from a fixed range, splitting blocks in halves
+// on demand and merging freed halves back together. Every node of a complete binary
+// tree over the smallest blocks stores the order of the largest free block below it
+// plus one, so that zero marks a node as allocated. Not thread safe.
+class BuddyAllocator
+{
+protected:
+    uint32_t m_minBlockShift;
+    uint32_t m_levelCount;
+    std::vector<uint8_t> m_nodes;
+
+    void updateParents(uint32_t node, uint8_t value);
+
+public:
+    static constexpr uint32_t s_invalidOffset = ~0u;
+
+    // Both sizes need to be powers of two
+    BuddyAllocator(uint32_t byteSize, uint32_t minBlockSize);
+
+    uint32_t getBlockSize(uint32_t byteSize) const;
+
+    // Returns s_invalidOffset when no block is large enough
+    uint32_t allocate(uint32_t byteSize);
+
+    // Returns the size of the freed block
+    uint32_t free(uint32_t offset);
+};
+
+#include "BuddyAllocator.inl"
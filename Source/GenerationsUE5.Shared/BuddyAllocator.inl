@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cassert>
+
+// Order of the smallest block fitting the given amount of minimum sized blocks
+inline uint32_t getBuddyOrder(uint32_t blockCount)
+{
+    uint32_t order = 0;
+    while ((1u << order) < blockCount)
+        ++order;
+
+    return order;
+}
+
+inline BuddyAllocator::BuddyAllocator(uint32_t byteSize, uint32_t minBlockSize)
+{
+    assert(byteSize >= minBlockSize && (byteSize & (byteSize - 1)) == 0 && (minBlockSize & (minBlockSize - 1)) == 0);
+
+    m_minBlockShift = getBuddyOrder(minBlockSize);
+    m_levelCount = getBuddyOrder(byteSize >> m_minBlockShift) + 1;
+    m_nodes.resize(1ull << m_levelCount);
+
+    // Everything starts out free, nodes hold their own order plus one
+    for (uint32_t depth = 0; depth < m_levelCount; depth++)
+        std::fill(m_nodes.begin() + (1ull << depth), m_nodes.begin() + (2ull << depth), static_cast<uint8_t>(m_levelCount - depth));
+}
+
+inline void BuddyAllocator::updateParents(uint32_t node, uint8_t value)
+{
+    // Children of a parent with order N are completely free when they hold N
+    while (node > 1)
+    {
+        node /= 2;
+        const uint8_t left = m_nodes[node * 2];
+        const uint8_t right = m_nodes[node * 2 + 1];
+
+        m_nodes[node] = left == value && right == value ? value + 1 : std::max(left, right);
+        ++value;
+    }
+}
+
+inline uint32_t BuddyAllocator::getBlockSize(uint32_t byteSize) const
+{
+    const uint32_t blockCount = (byteSize + (1u << m_minBlockShift) - 1) >> m_minBlockShift;
+    return (1u << m_minBlockShift) << getBuddyOrder(blockCount);
+}
+
+inline uint32_t BuddyAllocator::allocate(uint32_t byteSize)
+{
+    const uint32_t blockCount = (byteSize + (1u << m_minBlockShift) - 1) >> m_minBlockShift;
+    const uint32_t order = getBuddyOrder(blockCount);
+
+    if (order >= m_levelCount || m_nodes[1] <= order)
+        return s_invalidOffset;
+
+    // Prefer the left child to keep allocations packed towards the start
+    uint32_t node = 1;
+    for (uint32_t nodeOrder = m_levelCount - 1; nodeOrder > order; nodeOrder--)
+    {
+        node *= 2;
+        if (m_nodes[node] <= order)
+            ++node;
+    }
+
+    m_nodes[node] = 0;
+    updateParents(node, static_cast<uint8_t>(order + 1));
+
+    const uint32_t index = node - (1u << (m_levelCount - 1 - order));
+    return (index << order) << m_minBlockShift;
+}
+
+inline uint32_t BuddyAllocator::free(uint32_t offset)
+{
+    // Nodes below an allocated block are left untouched, the first allocated
+    // node on the way up from the smallest block is the one that got handed out
+    uint32_t node = (1u << (m_levelCount - 1)) + (offset >> m_minBlockShift);
+    uint32_t order = 0;
+
+    while (m_nodes[node] != 0)
+    {
+        node /= 2;
+        ++order;
+        assert(node != 0);
+    }
+
+    m_nodes[node] = static_cast<uint8_t>(order + 1);
+    updateParents(node, static_cast<uint8_t>(order + 1));
+
+    return (1u << m_minBlockShift) << order;
+}
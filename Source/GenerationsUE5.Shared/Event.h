@@ -1,11 +1,26 @@
 ﻿#pragma once
 
-#include <Windows.h>
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <string>
+#endif
 
 struct Event
 {
 protected:
+#ifdef _WIN32
     HANDLE m_handle = nullptr;
+#else
+    struct State;
+
+    State* m_state = nullptr;
+    int m_fd = -1;
+    std::string m_name;
+    bool m_created = false;
+
+    void openState(LPCTSTR name, bool create, BOOL initialState);
+#endif
 
 public:
     static constexpr TCHAR s_cpuEventName[] = TEXT("GenerationsUE5CPUEvent");
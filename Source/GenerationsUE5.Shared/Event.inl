@@ -1,5 +1,7 @@
 #include <cassert>
 
+#ifdef _WIN32
+
 inline Event::Event(LPCTSTR name, BOOL initialState)
 {
     m_handle = CreateEvent(
@@ -49,3 +51,173 @@ inline void Event::reset() const
     const BOOL result = ResetEvent(m_handle);
     assert(result == TRUE);
 }
+
+#else
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <ctime>
+
+// Manual reset event that can live in shared memory
+struct Event::State
+{
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+    std::atomic<uint32_t> initialized;
+};
+
+inline void Event::openState(LPCTSTR name, bool create, BOOL initialState)
+{
+    pthread_mutexattr_t mutexAttr;
+    pthread_mutexattr_init(&mutexAttr);
+
+    pthread_condattr_t condAttr;
+    pthread_condattr_init(&condAttr);
+
+    if (name == nullptr)
+    {
+        m_state = new State();
+    }
+    else
+    {
+        m_name = std::string("/") + name;
+
+        if (create)
+        {
+            m_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            m_created = m_fd >= 0;
+        }
+
+        if (!m_created)
+            m_fd = shm_open(m_name.c_str(), O_RDWR, 0600);
+
+        assert(m_fd >= 0);
+
+        if (m_created)
+        {
+            [[maybe_unused]] const int result = ftruncate(m_fd, sizeof(State));
+            assert(result == 0);
+        }
+        else
+        {
+            // Wait for the creator to size the object
+            struct stat fileStat {};
+            while (fstat(m_fd, &fileStat) == 0 && static_cast<size_t>(fileStat.st_size) < sizeof(State))
+                sched_yield();
+        }
+
+        m_state = static_cast<State*>(mmap(nullptr, sizeof(State), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0));
+        assert(m_state != MAP_FAILED);
+
+        pthread_mutexattr_setpshared(&mutexAttr, PTHREAD_PROCESS_SHARED);
+        pthread_condattr_setpshared(&condAttr, PTHREAD_PROCESS_SHARED);
+    }
+
+    if (name == nullptr || m_created)
+    {
+        pthread_mutex_init(&m_state->mutex, &mutexAttr);
+        pthread_cond_init(&m_state->cond, &condAttr);
+        m_state->signaled = initialState != FALSE;
+        m_state->initialized.store(1, std::memory_order_release);
+    }
+    else
+    {
+        while (m_state->initialized.load(std::memory_order_acquire) == 0)
+            sched_yield();
+    }
+
+    pthread_condattr_destroy(&condAttr);
+    pthread_mutexattr_destroy(&mutexAttr);
+}
+
+inline Event::Event(LPCTSTR name, BOOL initialState)
+{
+    openState(name, true, initialState);
+}
+
+inline Event::Event(LPCTSTR name)
+{
+    openState(name, false, FALSE);
+}
+
+inline Event::~Event()
+{
+    if (m_fd < 0)
+    {
+        pthread_cond_destroy(&m_state->cond);
+        pthread_mutex_destroy(&m_state->mutex);
+        delete m_state;
+        return;
+    }
+
+    if (m_created)
+    {
+        pthread_cond_destroy(&m_state->cond);
+        pthread_mutex_destroy(&m_state->mutex);
+    }
+
+    munmap(m_state, sizeof(State));
+    close(m_fd);
+
+    if (m_created)
+        shm_unlink(m_name.c_str());
+}
+
+inline void Event::wait() const
+{
+    pthread_mutex_lock(&m_state->mutex);
+
+    while (!m_state->signaled)
+        pthread_cond_wait(&m_state->cond, &m_state->mutex);
+
+    pthread_mutex_unlock(&m_state->mutex);
+}
+
+inline bool Event::waitImm() const
+{
+    timespec deadline{};
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += 1000000;
+
+    if (deadline.tv_nsec >= 1000000000)
+    {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
+    }
+
+    pthread_mutex_lock(&m_state->mutex);
+
+    int result = 0;
+    while (!m_state->signaled && result != ETIMEDOUT)
+        result = pthread_cond_timedwait(&m_state->cond, &m_state->mutex, &deadline);
+
+    const bool signaled = m_state->signaled;
+    pthread_mutex_unlock(&m_state->mutex);
+
+    return signaled;
+}
+
+inline void Event::set() const
+{
+    pthread_mutex_lock(&m_state->mutex);
+    m_state->signaled = true;
+    pthread_cond_broadcast(&m_state->cond);
+    pthread_mutex_unlock(&m_state->mutex);
+}
+
+inline void Event::reset() const
+{
+    pthread_mutex_lock(&m_state->mutex);
+    m_state->signaled = false;
+    pthread_mutex_unlock(&m_state->mutex);
+}
+
+#endif
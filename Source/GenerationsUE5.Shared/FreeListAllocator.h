@@ -1,15 +1,20 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 
 #ifndef _WIN64
 #include "Mutex.h"
 #endif
 
+// Hands out the lowest free index, so that ids stay dense for the bridge.
+// Free indices are tracked in a hierarchical bitmap: one bit per index at the
+// bottom, and one bit per word of the level below in every level above, which
+// makes both allocating and freeing logarithmic in the capacity.
 class FreeListAllocator
 {
 protected:
-    std::vector<uint32_t> m_indices;
+    std::vector<std::vector<uint32_t>> m_levels;
     uint32_t m_capacity = 1; // Reserve first index for NULL
 #ifndef _WIN64
     Mutex m_mutex;
@@ -20,4 +25,28 @@ public:
     void free(uint32_t index);
 };
 
+// Lock-free variant with a fixed capacity. Every index has a bit that gets set
+// while it's allocated, allocating claims the lowest clear bit with a CAS. A second
+// level marks the words that are full, letting allocations skip over them. Once the
+// capacity runs out, indices past it come from a locked FreeListAllocator instead.
+template<uint32_t Capacity>
+class LockFreeListAllocator
+{
+protected:
+    static_assert(Capacity % 1024 == 0);
+
+    static constexpr uint32_t s_wordCount = Capacity / 32;
+    static constexpr uint32_t s_summaryWordCount = s_wordCount / 32;
+
+    std::atomic<uint32_t> m_words[s_wordCount]{};
+    std::atomic<uint32_t> m_summaryWords[s_summaryWordCount]{};
+    FreeListAllocator m_overflow;
+
+public:
+    LockFreeListAllocator();
+
+    uint32_t allocate();
+    void free(uint32_t index);
+};
+
 #include "FreeListAllocator.inl"
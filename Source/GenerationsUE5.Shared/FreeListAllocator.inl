@@ -1,23 +1,51 @@
 #include "LockGuard.h"
 #include <cassert>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+inline uint32_t findLowestSetBit(uint32_t value)
+{
+    assert(value != 0);
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
 inline uint32_t FreeListAllocator::allocate()
 {
 #ifndef _WIN64
     LockGuard lock(m_mutex);
 #endif
 
-    uint32_t index;
-
-    if (!m_indices.empty())
+    // The top level is always a single word
+    if (m_levels.empty() || m_levels.back()[0] == 0)
     {
-        index = m_indices.back();
-        m_indices.pop_back();
+        const uint32_t index = m_capacity;
+        ++m_capacity;
+        return index;
     }
-    else
+
+    uint32_t index = 0;
+    for (size_t i = m_levels.size(); i > 0; i--)
+        index = index * 32 + findLowestSetBit(m_levels[i - 1][index]);
+
+    // Clear the bit, and the bits of the words above that become empty
+    uint32_t bitIndex = index;
+    for (auto& level : m_levels)
     {
-        index = m_capacity;
-        ++m_capacity;
+        uint32_t& word = level[bitIndex / 32];
+        word &= ~(1u << (bitIndex % 32));
+
+        if (word != 0)
+            break;
+
+        bitIndex /= 32;
     }
 
     return index;
@@ -25,10 +53,114 @@ inline uint32_t FreeListAllocator::allocate()
 
 inline void FreeListAllocator::free(uint32_t index)
 {
-    assert(index != NULL);
+    assert(index != 0);
 #ifndef _WIN64
     LockGuard lock(m_mutex);
 #endif
-    m_indices.insert(std::lower_bound(m_indices.begin(), m_indices.end(), index, std::greater<uint32_t>()), index);
+
+    // Grow the levels to cover the index, adding new levels until the top one fits in a word
+    uint32_t wordCount = index / 32 + 1;
+    for (size_t i = 0; ; i++)
+    {
+        const bool newLevel = i == m_levels.size();
+        if (newLevel)
+            m_levels.emplace_back();
+
+        auto& level = m_levels[i];
+        if (level.size() < wordCount)
+            level.resize(wordCount);
+
+        // Words of the old top level that have free indices need their bit in the new one
+        if (newLevel && i > 0)
+        {
+            const auto& levelBelow = m_levels[i - 1];
+            for (uint32_t j = 0; j < levelBelow.size(); j++)
+            {
+                if (levelBelow[j] != 0)
+                    level[j / 32] |= 1u << (j % 32);
+            }
+        }
+
+        if (level.size() == 1)
+            break;
+
+        wordCount = static_cast<uint32_t>(level.size() + 31) / 32;
+    }
+
+    // Set the bit, and the bits of the words above that were empty until now
+    uint32_t bitIndex = index;
+    for (auto& level : m_levels)
+    {
+        uint32_t& word = level[bitIndex / 32];
+        const bool wasEmpty = word == 0;
+        word |= 1u << (bitIndex % 32);
+
+        if (!wasEmpty)
+            break;
+
+        bitIndex /= 32;
+    }
+}
+
+template<uint32_t Capacity>
+LockFreeListAllocator<Capacity>::LockFreeListAllocator()
+{
+    // Reserve first index for NULL
+    m_words[0].store(1);
 }
 
+template<uint32_t Capacity>
+uint32_t LockFreeListAllocator<Capacity>::allocate()
+{
+    for (uint32_t i = 0; i < s_summaryWordCount; i++)
+    {
+        uint32_t fullWords = m_summaryWords[i].load();
+
+        while (fullWords != ~0u)
+        {
+            const uint32_t wordIndex = i * 32 + findLowestSetBit(~fullWords);
+            auto& word = m_words[wordIndex];
+
+            uint32_t value = word.load();
+            while (value != ~0u)
+            {
+                const uint32_t bit = 1u << findLowestSetBit(~value);
+
+                if (word.compare_exchange_weak(value, value | bit))
+                {
+                    if ((value | bit) == ~0u)
+                    {
+                        // A free in between could have made room again, which would
+                        // leave the word marked as full with nobody to clear it
+                        m_summaryWords[i].fetch_or(1u << (wordIndex % 32));
+
+                        if (word.load() != ~0u)
+                            m_summaryWords[i].fetch_and(~(1u << (wordIndex % 32)));
+                    }
+
+                    return wordIndex * 32 + findLowestSetBit(bit);
+                }
+            }
+
+            fullWords |= 1u << (wordIndex % 32);
+        }
+    }
+
+    // The overflow allocator starts at one, which maps to the capacity
+    return Capacity - 1 + m_overflow.allocate();
+}
+
+template<uint32_t Capacity>
+void LockFreeListAllocator<Capacity>::free(uint32_t index)
+{
+    assert(index != 0);
+
+    if (index >= Capacity)
+    {
+        m_overflow.free(index - Capacity + 1);
+        return;
+    }
+
+    m_words[index / 32].fetch_and(~(1u << (index % 32)));
+    m_summaryWords[index / 1024].fetch_and(~(1u << (index / 32 % 32)));
+}
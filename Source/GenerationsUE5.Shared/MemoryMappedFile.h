@@ -1,11 +1,22 @@
 ﻿#pragma once
 
-#include <Windows.h>
+#include "Platform.h"
+
+#ifndef _WIN32
+#include <string>
+#endif
 
 class MemoryMappedFile
 {
 protected:
+#ifdef _WIN32
     HANDLE m_handle = nullptr;
+#else
+    int m_fd = -1;
+    size_t m_size = 0;
+    std::string m_name;
+    bool m_created = false;
+#endif
 #ifdef _DEBUG
     mutable bool m_mapped = false;
 #endif
@@ -15,6 +26,7 @@ public:
     static constexpr TCHAR s_name[] = TEXT("GenerationsUE5MemoryMappedFile");
 
     MemoryMappedFile();
+    MemoryMappedFile(LPCTSTR name, size_t size);
     ~MemoryMappedFile();
 
     void* map() const;
@@ -1,12 +1,26 @@
 #include <cassert>
 
-inline MemoryMappedFile::MemoryMappedFile()
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+inline MemoryMappedFile::MemoryMappedFile() : MemoryMappedFile(s_name, s_size)
+{
+}
+
+#ifdef _WIN32
+
+inline MemoryMappedFile::MemoryMappedFile(LPCTSTR name, size_t size)
 {
 #ifdef _WIN64
+    // The bridge needs write access to advance the cursors of the message ring.
     m_handle = OpenFileMapping(
-        FILE_MAP_READ,
+        FILE_MAP_READ | FILE_MAP_WRITE,
         FALSE,
-        s_name);
+        name);
 
     static_assert(sizeof(size_t) == 8);
 #else
@@ -15,8 +29,8 @@ inline MemoryMappedFile::MemoryMappedFile()
         nullptr,
         PAGE_READWRITE,
         0,
-        s_size,
-        s_name);
+        size,
+        name);
 
     static_assert(sizeof(size_t) == 4);
 #endif
@@ -37,7 +51,7 @@ inline void* MemoryMappedFile::map() const
     void* result = MapViewOfFile(
         m_handle,
 #ifdef _WIN64
-        FILE_MAP_READ,
+        FILE_MAP_READ | FILE_MAP_WRITE,
 #else
         FILE_MAP_WRITE,
 #endif
@@ -67,4 +81,81 @@ inline void MemoryMappedFile::unmap(void* buffer) const
 #ifdef _DEBUG
     m_mapped = false;
 #endif
-}
\ No newline at end of file
+}
+
+#else
+
+inline MemoryMappedFile::MemoryMappedFile(LPCTSTR name, size_t size)
+{
+    // Whichever process comes first creates the shared memory object,
+    // the other one opens it and grows it if it asks for more.
+    m_name = std::string("/") + name;
+    m_fd = shm_open(m_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+
+    if (m_fd >= 0)
+        m_created = true;
+    else
+        m_fd = shm_open(m_name.c_str(), O_RDWR, 0600);
+
+    assert(m_fd >= 0);
+
+    struct stat fileStat {};
+    fstat(m_fd, &fileStat);
+
+    if (static_cast<size_t>(fileStat.st_size) < size)
+    {
+        [[maybe_unused]] const int result = ftruncate(m_fd, static_cast<off_t>(size));
+        assert(result == 0);
+        m_size = size;
+    }
+    else
+    {
+        m_size = static_cast<size_t>(fileStat.st_size);
+    }
+}
+
+inline MemoryMappedFile::~MemoryMappedFile()
+{
+#ifdef _DEBUG
+    assert(!m_mapped);
+#endif
+    close(m_fd);
+
+    if (m_created)
+        shm_unlink(m_name.c_str());
+}
+
+inline void* MemoryMappedFile::map() const
+{
+#ifdef _DEBUG
+    assert(!m_mapped);
+#endif
+
+    void* result = mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    assert(result != MAP_FAILED);
+
+#ifdef _DEBUG
+    m_mapped = true;
+#endif
+    return result;
+}
+
+inline void MemoryMappedFile::flush(void* buffer, size_t size) const
+{
+    [[maybe_unused]] const int result = msync(buffer, size, MS_SYNC);
+    assert(result == 0);
+}
+
+inline void MemoryMappedFile::unmap(void* buffer) const
+{
+#ifdef _DEBUG
+    assert(m_mapped);
+#endif
+    [[maybe_unused]] const int result = munmap(buffer, m_size);
+    assert(result == 0);
+#ifdef _DEBUG
+    m_mapped = false;
+#endif
+}
+
+#endif
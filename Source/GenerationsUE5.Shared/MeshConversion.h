@@ -0,0 +1,148 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Conversion of the big-endian meshes in Hedgehog Engine models to the layout the
+// mod renders and traces with. Shared between the runtime, which converts meshes
+// as they get loaded, and the offline model converter, which bakes them into files.
+
+enum DeclType : uint32_t
+{
+    DECLTYPE_FLOAT1 = 0x2C83A4,
+    DECLTYPE_FLOAT2 = 0x2C23A5,
+    DECLTYPE_FLOAT3 = 0x2A23B9,
+    DECLTYPE_FLOAT4 = 0x1A23A6,
+    DECLTYPE_D3DCOLOR = 0x182886,
+    DECLTYPE_UBYTE4 = 0x1A2286,
+    DECLTYPE_SHORT2 = 0x2C2359,
+    DECLTYPE_SHORT4 = 0x1A235A,
+    DECLTYPE_UBYTE4N = 0x1A2086,
+    DECLTYPE_SHORT2N = 0x2C2159,
+    DECLTYPE_SHORT4N = 0x1A215A,
+    DECLTYPE_USHORT2N = 0x2C2059,
+    DECLTYPE_USHORT4N = 0x1A205A,
+    DECLTYPE_UDEC3 = 0x2A2287,
+    DECLTYPE_UDEC3N = 0x2A2087,
+    DECLTYPE_DEC3N = 0x2A2187,
+    DECLTYPE_HEND3N = 0x2A2190,
+    DECLTYPE_FLOAT16_2 = 0x2C235F,
+    DECLTYPE_FLOAT16_4 = 0x1A2360,
+    DECLTYPE_UNUSED = 0xFFFFFFFF
+};
+
+// Same values as D3DDECLUSAGE, which isn't available outside of Windows
+enum DeclUsage : uint8_t
+{
+    DECLUSAGE_POSITION = 0,
+    DECLUSAGE_BLENDWEIGHT = 1,
+    DECLUSAGE_BLENDINDICES = 2,
+    DECLUSAGE_NORMAL = 3,
+    DECLUSAGE_TEXCOORD = 5,
+    DECLUSAGE_TANGENT = 6,
+    DECLUSAGE_BINORMAL = 7,
+    DECLUSAGE_COLOR = 10
+};
+
+struct VertexElement
+{
+    uint16_t stream;
+    uint16_t offset;
+    uint32_t type;
+    uint8_t method;
+    uint8_t usage;
+    uint8_t usageIndex;
+};
+
+static_assert(sizeof(VertexElement) == 0xC);
+
+enum class VertexConversionType
+{
+    None,
+    Swap32,
+    Swap32x3,
+    Swap16x2,
+    Float3ToUdec3n,
+    Dec3nToUdec3n,
+    Float2ToHalf2,
+    Float4ToUbyte4n
+};
+
+// One vertex element over a run of vertices
+struct VertexStream
+{
+    const uint8_t* source;
+    uint32_t sourceStride;
+    uint8_t* destination;
+    uint32_t destinationStride;
+    uint32_t count;
+};
+
+// Reused between meshes to avoid allocating for every one of them
+struct TriangleReorderScratch
+{
+    std::vector<uint64_t> keys;
+    std::vector<uint16_t> indices;
+    std::vector<uint32_t> localVertices;
+    std::vector<uint32_t> globalVertices;
+    std::vector<uint32_t> adjacency;
+    std::vector<int32_t> cachePositions;
+    std::vector<float> vertexScores;
+    std::vector<uint32_t> remainingCounts;
+    std::vector<float> triangleScores;
+    std::vector<bool> emitted;
+};
+
+struct VertexWeldScratch
+{
+    std::vector<uint32_t> table;
+    std::vector<uint16_t> remap;
+};
+
+struct MeshConversion
+{
+    static uint16_t byteSwap(uint16_t value);
+    static uint32_t byteSwap(uint32_t value);
+
+    static uint32_t getDeclTypeSize(uint32_t declType);
+
+    // Scalar reference for the vertex element conversions
+    static void convertScalar(VertexConversionType type, const VertexStream& stream);
+    static void byteSwap32Scalar(uint8_t* destination, const uint8_t* source, size_t byteSize);
+
+    // Rewrites the vertex data and elements in place to the optimized vertex format. Returns
+    // the new vertex size, or 0 without changing anything if the format doesn't fit in the old one.
+    // Terrain meshes are never skinned and lose their blend weights.
+    template<typename TConvert, typename TByteSwap32>
+    static uint32_t optimizeVertexFormat(uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexSize,
+        VertexElement* vertexElements, uint32_t nodeCount, bool terrain, std::vector<uint8_t>& scratch,
+        const TConvert& convert, const TByteSwap32& byteSwap32);
+
+    // Appends the triangle list of big-endian triangle strips with restart indices, skipping degenerate triangles
+    static void convertToTriangles(const uint16_t* indices, uint32_t indexCount, std::vector<uint16_t>& triangles);
+
+    // Merges bit-identical vertices, which become common once normals and texture coordinates get quantized.
+    // Compacts the vertex data in place, remaps the big-endian indices and returns the new vertex count.
+    // Whole vertices get compared, so skinned vertices only merge if their blend indices and weights match too.
+    // Indices may be triangle lists or strips, restart indices are left alone.
+    static uint32_t weldVertices(uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexSize,
+        uint16_t* indices, uint32_t indexCount, VertexWeldScratch& scratch);
+
+    // Sorts triangles by the Morton code of their centroid, then optimizes them for the vertex cache in
+    // clusters of consecutive triangles. Spatially coherent triangles make for tighter bounding volumes
+    // when building acceleration structures, and the clusters keep most of the vertex cache hits.
+    // Positions are big-endian float3 values, as mesh resources stay big-endian even after optimizing them.
+    static void reorderTriangles(uint16_t* indices, uint32_t indexCount, const uint8_t* positions,
+        uint32_t positionStride, uint32_t vertexCount, TriangleReorderScratch& scratch);
+
+    // Triangles adjacent to every vertex, as an offset and count pair per vertex followed by the triangle indices.
+    // Every index adds one triangle index, so the size is known up front and the adjacency can be counting
+    // sorted straight into the destination without any allocations.
+    static size_t getAdjacencySize(uint32_t vertexCount, uint32_t indexCount);
+
+    template<typename TGetIndex>
+    static void generateAdjacency(uint32_t vertexCount, uint32_t indexCount, const TGetIndex& getIndex, uint32_t* adjacency);
+};
+
+#include "MeshConversion.inl"
@@ -0,0 +1,755 @@
+#include "MeshOpt.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+inline uint16_t MeshConversion::byteSwap(uint16_t value)
+{
+#ifdef _MSC_VER
+    return _byteswap_ushort(value);
+#else
+    return __builtin_bswap16(value);
+#endif
+}
+
+inline uint32_t MeshConversion::byteSwap(uint32_t value)
+{
+#ifdef _MSC_VER
+    return _byteswap_ulong(value);
+#else
+    return __builtin_bswap32(value);
+#endif
+}
+
+inline uint32_t MeshConversion::getDeclTypeSize(uint32_t declType)
+{
+    switch (declType)
+    {
+    case DECLTYPE_FLOAT1: return 4;
+    case DECLTYPE_FLOAT2: return 8;
+    case DECLTYPE_FLOAT3: return 12;
+    case DECLTYPE_FLOAT4: return 16;
+    case DECLTYPE_D3DCOLOR: return 4;
+    case DECLTYPE_UBYTE4: return 4;
+    case DECLTYPE_SHORT2: return 4;
+    case DECLTYPE_SHORT4: return 8;
+    case DECLTYPE_UBYTE4N: return 4;
+    case DECLTYPE_SHORT2N: return 4;
+    case DECLTYPE_SHORT4N: return 8;
+    case DECLTYPE_USHORT2N: return 4;
+    case DECLTYPE_USHORT4N: return 8;
+    case DECLTYPE_UDEC3: return 4;
+    case DECLTYPE_UDEC3N: return 4;
+    case DECLTYPE_DEC3N: return 4;
+    case DECLTYPE_HEND3N: return 4;
+    case DECLTYPE_FLOAT16_2: return 4;
+    case DECLTYPE_FLOAT16_4: return 8;
+    }
+
+    return 0;
+}
+
+namespace MeshConversionDetail
+{
+    inline uint32_t load32(const uint8_t* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(value));
+        return MeshConversion::byteSwap(value);
+    }
+
+    inline float loadFloat(const uint8_t* data)
+    {
+        const uint32_t value = load32(data);
+        float result;
+        memcpy(&result, &value, sizeof(result));
+        return result;
+    }
+
+    inline void store32(uint8_t* data, uint32_t value)
+    {
+        memcpy(data, &value, sizeof(value));
+    }
+
+    inline uint32_t dec3nToUdec3n(uint32_t value)
+    {
+        int32_t signExtend = static_cast<int32_t>((value << 22) | value);
+        signExtend += 511;
+        return static_cast<uint32_t>(signExtend) & 0x3FF;
+    }
+
+    // Same as quantizeSnorm10 of a normalized Eigen vector, which sums the squared norm
+    // as x + (y + z) and divides by its square root unless it's zero
+    inline uint32_t normalizeAndQuantizeSnorm10(float x, float y, float z)
+    {
+        const float squaredNorm = x * x + (y * y + z * z);
+        if (squaredNorm > 0.0f)
+        {
+            const float norm = std::sqrt(squaredNorm);
+            x /= norm;
+            y /= norm;
+            z /= norm;
+        }
+
+        return (quantizeUnorm(x * 0.5f + 0.5f, 10) & 0x3FF) |
+            ((quantizeUnorm(y * 0.5f + 0.5f, 10) & 0x3FF) << 10) |
+            ((quantizeUnorm(z * 0.5f + 0.5f, 10) & 0x3FF) << 20);
+    }
+
+    inline void convertVertex(VertexConversionType type, const uint8_t* source, uint8_t* destination)
+    {
+        switch (type)
+        {
+        case VertexConversionType::Swap32:
+        {
+            store32(destination, load32(source));
+            break;
+        }
+
+        case VertexConversionType::Swap32x3:
+        {
+            for (size_t i = 0; i < 3; i++)
+                store32(destination + i * 4, load32(source + i * 4));
+
+            break;
+        }
+
+        case VertexConversionType::Swap16x2:
+        {
+            for (size_t i = 0; i < 2; i++)
+            {
+                uint16_t value;
+                memcpy(&value, source + i * 2, sizeof(value));
+                value = MeshConversion::byteSwap(value);
+                memcpy(destination + i * 2, &value, sizeof(value));
+            }
+
+            break;
+        }
+
+        case VertexConversionType::Float3ToUdec3n:
+        {
+            store32(destination, normalizeAndQuantizeSnorm10(loadFloat(source), loadFloat(source + 4), loadFloat(source + 8)));
+            break;
+        }
+
+        case VertexConversionType::Dec3nToUdec3n:
+        {
+            const uint32_t value = load32(source);
+
+            store32(destination,
+                dec3nToUdec3n(value & 0x3FF) |
+                (dec3nToUdec3n((value >> 10) & 0x3FF) << 10) |
+                (dec3nToUdec3n((value >> 20) & 0x3FF) << 20));
+
+            break;
+        }
+
+        case VertexConversionType::Float2ToHalf2:
+        {
+            for (size_t i = 0; i < 2; i++)
+            {
+                const uint16_t value = quantizeHalf(loadFloat(source + i * 4));
+                memcpy(destination + i * 2, &value, sizeof(value));
+            }
+
+            break;
+        }
+
+        case VertexConversionType::Float4ToUbyte4n:
+        {
+            for (size_t i = 0; i < 4; i++)
+                destination[i] = static_cast<uint8_t>(std::clamp(static_cast<uint32_t>(loadFloat(source + i * 4) * 255.0f), 0u, 255u));
+
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+inline void MeshConversion::convertScalar(VertexConversionType type, const VertexStream& stream)
+{
+    for (size_t i = 0; i < stream.count; i++)
+    {
+        MeshConversionDetail::convertVertex(type,
+            stream.source + i * stream.sourceStride, stream.destination + i * stream.destinationStride);
+    }
+}
+
+inline void MeshConversion::byteSwap32Scalar(uint8_t* destination, const uint8_t* source, size_t byteSize)
+{
+    for (size_t i = 0; i < byteSize; i += 4)
+        MeshConversionDetail::store32(destination + i, MeshConversionDetail::load32(source + i));
+}
+
+template<typename TConvert, typename TByteSwap32>
+uint32_t MeshConversion::optimizeVertexFormat(uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexSize,
+    VertexElement* vertexElements, uint32_t nodeCount, bool terrain, std::vector<uint8_t>& scratch,
+    const TConvert& convert, const TByteSwap32& byteSwap32)
+{
+    uint32_t offsets[14][4]{};
+    bool usages[14][4]{};
+
+    VertexElement* vertexElement = vertexElements;
+    while (byteSwap(vertexElement->stream) != 0xFF && vertexElement->type != DECLTYPE_UNUSED)
+    {
+        offsets[vertexElement->usage][vertexElement->usageIndex] = byteSwap(vertexElement->offset);
+
+        auto& valid = usages[vertexElement->usage][vertexElement->usageIndex];
+
+        if (byteSwap(vertexElement->type) == DECLTYPE_FLOAT2 && vertexElement->usage == DECLUSAGE_TEXCOORD && vertexElement->usageIndex != 0)
+        {
+            bool allZero = true;
+            bool allSame = true;
+
+            for (size_t i = 0; i < vertexCount; i++)
+            {
+                const uint8_t* vertex = vertexData + i * vertexSize;
+
+                uint32_t texCoordN[2];
+                memcpy(texCoordN, vertex + offsets[DECLUSAGE_TEXCOORD][vertexElement->usageIndex], sizeof(texCoordN));
+
+                if (texCoordN[0] != 0 || texCoordN[1] != 0)
+                    allZero = false;
+
+                uint32_t texCoord0[2];
+                memcpy(texCoord0, vertex + offsets[DECLUSAGE_TEXCOORD][0], sizeof(texCoord0));
+
+                if (texCoordN[0] != texCoord0[0] || texCoordN[1] != texCoord0[1])
+                    allSame = false;
+
+                valid = !allZero && !allSame;
+
+                if (valid)
+                    break;
+            }
+        }
+        else
+        {
+            valid = true;
+        }
+
+        ++vertexElement;
+    }
+
+    usages[DECLUSAGE_POSITION][0] = true;
+    usages[DECLUSAGE_COLOR][0] = true;
+    usages[DECLUSAGE_NORMAL][0] = true;
+    usages[DECLUSAGE_TANGENT][0] = true;
+    usages[DECLUSAGE_BINORMAL][0] = true;
+    usages[DECLUSAGE_TEXCOORD][0] = true;
+
+    if (terrain || nodeCount <= 1)
+    {
+        usages[DECLUSAGE_BLENDWEIGHT][0] = false;
+        usages[DECLUSAGE_BLENDINDICES][0] = false;
+    }
+
+    if (nodeCount <= 4)
+    {
+        usages[DECLUSAGE_BLENDWEIGHT][1] = false;
+        usages[DECLUSAGE_BLENDINDICES][1] = false;
+    }
+
+    VertexElement elements[32]{};
+    uint32_t elementIndex = 0;
+    uint32_t newVertexSize = 0;
+
+    const std::pair<uint8_t, uint32_t> usageAndTypePairs[] =
+    {
+        { DECLUSAGE_POSITION, DECLTYPE_FLOAT3 },
+        { DECLUSAGE_COLOR, DECLTYPE_UBYTE4N },
+        { DECLUSAGE_NORMAL, DECLTYPE_UDEC3N },
+        { DECLUSAGE_TANGENT, DECLTYPE_UDEC3N },
+        { DECLUSAGE_BINORMAL, DECLTYPE_UDEC3N },
+        { DECLUSAGE_TEXCOORD, DECLTYPE_FLOAT16_2 },
+        { DECLUSAGE_BLENDINDICES, DECLTYPE_UBYTE4 },
+        { DECLUSAGE_BLENDWEIGHT, DECLTYPE_UBYTE4N }
+    };
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        for (const auto& [usage, type] : usageAndTypePairs)
+        {
+            if (usages[usage][i])
+            {
+                auto& element = elements[elementIndex];
+                element.stream = 0;
+                element.offset = byteSwap(static_cast<uint16_t>(newVertexSize));
+                element.type = byteSwap(type);
+                element.method = 0;
+                element.usage = usage;
+                element.usageIndex = i;
+                ++elementIndex;
+
+                offsets[usage][i] = newVertexSize;
+                newVertexSize += getDeclTypeSize(type);
+            }
+        }
+    }
+
+    if (vertexSize < newVertexSize)
+        return 0;
+
+    elements[elementIndex].stream = 0xFF00;
+    elements[elementIndex].type = DECLTYPE_UNUSED;
+    ++elementIndex;
+
+    scratch.resize(vertexCount * newVertexSize);
+
+    // Elements get converted one at a time for all vertices, in declaration order
+    // so that duplicate elements overwrite each other like they would per vertex
+    vertexElement = vertexElements;
+    while (byteSwap(vertexElement->stream) != 0xFF && vertexElement->type != DECLTYPE_UNUSED)
+    {
+        if (usages[vertexElement->usage][vertexElement->usageIndex])
+        {
+            VertexConversionType conversionType = VertexConversionType::None;
+            const uint32_t type = byteSwap(vertexElement->type);
+
+            switch (vertexElement->usage)
+            {
+            case DECLUSAGE_POSITION:
+                conversionType = VertexConversionType::Swap32x3;
+                break;
+
+            case DECLUSAGE_NORMAL:
+            case DECLUSAGE_TANGENT:
+            case DECLUSAGE_BINORMAL:
+                conversionType = type == DECLTYPE_FLOAT3 ? VertexConversionType::Float3ToUdec3n : VertexConversionType::Dec3nToUdec3n;
+                break;
+
+            case DECLUSAGE_TEXCOORD:
+                conversionType = type == DECLTYPE_FLOAT2 ? VertexConversionType::Float2ToHalf2 : VertexConversionType::Swap16x2;
+                break;
+
+            case DECLUSAGE_COLOR:
+                conversionType = type == DECLTYPE_FLOAT4 ? VertexConversionType::Float4ToUbyte4n : VertexConversionType::Swap32;
+                break;
+
+            case DECLUSAGE_BLENDINDICES:
+            case DECLUSAGE_BLENDWEIGHT:
+                conversionType = VertexConversionType::Swap32;
+                break;
+            }
+
+            VertexStream stream;
+            stream.source = vertexData + byteSwap(vertexElement->offset);
+            stream.sourceStride = vertexSize;
+            stream.destination = scratch.data() + offsets[vertexElement->usage][vertexElement->usageIndex];
+            stream.destinationStride = newVertexSize;
+            stream.count = vertexCount;
+
+            if (conversionType != VertexConversionType::None)
+                convert(conversionType, stream);
+        }
+
+        ++vertexElement;
+    }
+
+    byteSwap32(vertexData, scratch.data(), scratch.size());
+
+    memcpy(vertexElements, elements, elementIndex * sizeof(VertexElement));
+
+    return newVertexSize;
+}
+
+inline void MeshConversion::convertToTriangles(const uint16_t* indices, uint32_t indexCount, std::vector<uint16_t>& triangles)
+{
+    if (indexCount <= 2)
+        return;
+
+    triangles.reserve(triangles.size() + (indexCount - 2) * 3);
+
+    size_t start = 0;
+
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        if (indices[i] == 0xFFFF)
+        {
+            start = i + 1;
+        }
+        else if (i - start >= 2)
+        {
+            uint16_t a = byteSwap(indices[i - 2]);
+            uint16_t b = byteSwap(indices[i - 1]);
+            uint16_t c = byteSwap(indices[i]);
+
+            if ((i - start) & 1)
+                std::swap(a, b);
+
+            if (a != b && a != c && b != c)
+            {
+                triangles.push_back(a);
+                triangles.push_back(b);
+                triangles.push_back(c);
+            }
+        }
+    }
+}
+
+inline uint32_t MeshConversion::weldVertices(uint8_t* vertexData, uint32_t vertexCount, uint32_t vertexSize,
+    uint16_t* indices, uint32_t indexCount, VertexWeldScratch& scratch)
+{
+    // Open addressing with linear probing, kept at most half full
+    uint32_t tableSize = 1;
+    while (tableSize < vertexCount * 2)
+        tableSize <<= 1;
+
+    scratch.table.assign(tableSize, ~0u);
+    scratch.remap.resize(vertexCount);
+
+    uint32_t newVertexCount = 0;
+
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        const uint8_t* vertex = vertexData + i * vertexSize;
+
+        // FNV-1a
+        uint32_t hash = 0x811C9DC5;
+        for (uint32_t j = 0; j < vertexSize; j++)
+            hash = (hash ^ vertex[j]) * 0x1000193;
+
+        uint32_t slot = hash & (tableSize - 1);
+
+        while (scratch.table[slot] != ~0u && memcmp(vertexData + scratch.table[slot] * vertexSize, vertex, vertexSize) != 0)
+            slot = (slot + 1) & (tableSize - 1);
+
+        if (scratch.table[slot] == ~0u)
+        {
+            // Unique vertices only ever move towards the start, over vertices that are already processed
+            if (newVertexCount != i)
+                memcpy(vertexData + newVertexCount * vertexSize, vertex, vertexSize);
+
+            scratch.table[slot] = newVertexCount;
+            ++newVertexCount;
+        }
+
+        scratch.remap[i] = static_cast<uint16_t>(scratch.table[slot]);
+    }
+
+    if (newVertexCount != vertexCount)
+    {
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            const uint16_t index = byteSwap(indices[i]);
+            if (index < vertexCount)
+                indices[i] = byteSwap(scratch.remap[index]);
+        }
+    }
+
+    return newVertexCount;
+}
+
+inline size_t MeshConversion::getAdjacencySize(uint32_t vertexCount, uint32_t indexCount)
+{
+    return static_cast<size_t>(vertexCount) * 2 + indexCount;
+}
+
+template<typename TGetIndex>
+void MeshConversion::generateAdjacency(uint32_t vertexCount, uint32_t indexCount, const TGetIndex& getIndex, uint32_t* adjacency)
+{
+    uint32_t* metadata = adjacency;
+    uint32_t* triangles = adjacency + static_cast<size_t>(vertexCount) * 2;
+
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        metadata[i * 2] = 0;
+        metadata[i * 2 + 1] = 0;
+    }
+
+    for (uint32_t i = 0; i < indexCount; i++)
+        ++metadata[getIndex(i) * 2 + 1];
+
+    // The offsets are used as write cursors and end up pointing past the
+    // end of every vertex's triangles, which is fixed up at the end
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        metadata[i * 2] = offset;
+        offset += metadata[i * 2 + 1];
+    }
+
+    for (uint32_t i = 0; i < indexCount; i++)
+    {
+        uint32_t& cursor = metadata[getIndex(i) * 2];
+        triangles[cursor] = i / 3;
+        ++cursor;
+    }
+
+    for (uint32_t i = 0; i < vertexCount; i++)
+        metadata[i * 2] -= metadata[i * 2 + 1];
+}
+
+namespace MeshConversionDetail
+{
+    inline uint32_t expandBits10(uint32_t value)
+    {
+        value &= 0x3FF;
+        value = (value | (value << 16)) & 0x030000FF;
+        value = (value | (value << 8)) & 0x0300F00F;
+        value = (value | (value << 4)) & 0x030C30C3;
+        value = (value | (value << 2)) & 0x09249249;
+        return value;
+    }
+
+    // Clamps NaN to zero as well
+    inline uint32_t quantizeMorton(float value, float min, float scale)
+    {
+        value = (value - min) * scale;
+        value = (value >= 0.0f) ? value : 0.0f;
+        value = (value <= 1023.0f) ? value : 1023.0f;
+        return static_cast<uint32_t>(value);
+    }
+
+    constexpr uint32_t s_vertexCacheSize = 32;
+    constexpr uint32_t s_clusterSize = 256;
+    constexpr uint32_t s_maxValence = 64;
+
+    // https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+    struct VertexScoreTable
+    {
+        float cacheScores[s_vertexCacheSize];
+        float valenceScores[s_maxValence];
+
+        VertexScoreTable()
+        {
+            for (uint32_t i = 0; i < s_vertexCacheSize; i++)
+            {
+                // The last triangle's vertices get a fixed score so that strips don't get preferred
+                cacheScores[i] = i < 3 ? 0.75f :
+                    std::pow(1.0f - static_cast<float>(i - 3) / static_cast<float>(s_vertexCacheSize - 3), 1.5f);
+            }
+
+            valenceScores[0] = 0.0f;
+            for (uint32_t i = 1; i < s_maxValence; i++)
+                valenceScores[i] = 2.0f / std::sqrt(static_cast<float>(i));
+        }
+    };
+
+    inline float getVertexScore(int32_t cachePosition, uint32_t remainingCount)
+    {
+        static const VertexScoreTable s_table;
+
+        if (remainingCount == 0)
+            return -1.0f;
+
+        float score = cachePosition >= 0 ? s_table.cacheScores[cachePosition] : 0.0f;
+
+        if (remainingCount < s_maxValence)
+            score += s_table.valenceScores[remainingCount];
+        else
+            score += 2.0f / std::sqrt(static_cast<float>(remainingCount));
+
+        return score;
+    }
+
+    inline void optimizeVertexCache(const uint16_t* source, uint32_t triangleCount, uint16_t* destination, TriangleReorderScratch& scratch)
+    {
+        // Local vertex indices keep the state as small as the cluster
+        scratch.globalVertices.clear();
+
+        for (uint32_t i = 0; i < triangleCount * 3; i++)
+        {
+            auto& localVertex = scratch.localVertices[source[i]];
+            if (localVertex == ~0u)
+            {
+                localVertex = static_cast<uint32_t>(scratch.globalVertices.size());
+                scratch.globalVertices.push_back(source[i]);
+            }
+        }
+
+        const uint32_t vertexCount = static_cast<uint32_t>(scratch.globalVertices.size());
+
+        scratch.adjacency.resize(MeshConversion::getAdjacencySize(vertexCount, triangleCount * 3));
+        MeshConversion::generateAdjacency(vertexCount, triangleCount * 3,
+            [&](uint32_t i) { return scratch.localVertices[source[i]]; }, scratch.adjacency.data());
+
+        const uint32_t* adjacentTriangles = scratch.adjacency.data() + vertexCount * 2;
+
+        scratch.cachePositions.assign(vertexCount, -1);
+        scratch.remainingCounts.resize(vertexCount);
+        scratch.vertexScores.resize(vertexCount);
+
+        for (uint32_t i = 0; i < vertexCount; i++)
+        {
+            scratch.remainingCounts[i] = scratch.adjacency[i * 2 + 1];
+            scratch.vertexScores[i] = getVertexScore(-1, scratch.remainingCounts[i]);
+        }
+
+        scratch.triangleScores.resize(triangleCount);
+        scratch.emitted.assign(triangleCount, false);
+
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            scratch.triangleScores[i] = 0.0f;
+            for (uint32_t j = 0; j < 3; j++)
+                scratch.triangleScores[i] += scratch.vertexScores[scratch.localVertices[source[i * 3 + j]]];
+        }
+
+        uint32_t cache[s_vertexCacheSize + 3];
+        uint32_t cacheSize = 0;
+        uint32_t nextTriangle = 0;
+        int32_t bestTriangle = -1;
+
+        for (uint32_t i = 0; i < triangleCount; i++)
+        {
+            // Continue in Morton order when nothing in the cache is left
+            if (bestTriangle < 0)
+            {
+                while (scratch.emitted[nextTriangle])
+                    ++nextTriangle;
+
+                bestTriangle = static_cast<int32_t>(nextTriangle);
+            }
+
+            scratch.emitted[bestTriangle] = true;
+
+            uint32_t newCache[s_vertexCacheSize + 3];
+            uint32_t newCacheSize = 0;
+
+            for (uint32_t j = 0; j < 3; j++)
+            {
+                destination[i * 3 + j] = source[bestTriangle * 3 + j];
+
+                const uint32_t vertex = scratch.localVertices[source[bestTriangle * 3 + j]];
+                --scratch.remainingCounts[vertex];
+                newCache[newCacheSize] = vertex;
+                ++newCacheSize;
+            }
+
+            for (uint32_t j = 0; j < cacheSize; j++)
+            {
+                if (cache[j] != newCache[0] && cache[j] != newCache[1] && cache[j] != newCache[2])
+                {
+                    newCache[newCacheSize] = cache[j];
+                    ++newCacheSize;
+                }
+            }
+
+            // Vertices past the cache size fall out of it, but still need their scores updated
+            for (uint32_t j = 0; j < newCacheSize; j++)
+            {
+                const uint32_t vertex = newCache[j];
+                scratch.cachePositions[vertex] = j < s_vertexCacheSize ? static_cast<int32_t>(j) : -1;
+
+                const float score = getVertexScore(scratch.cachePositions[vertex], scratch.remainingCounts[vertex]);
+                const float delta = score - scratch.vertexScores[vertex];
+                scratch.vertexScores[vertex] = score;
+
+                for (uint32_t k = 0; k < scratch.adjacency[vertex * 2 + 1]; k++)
+                    scratch.triangleScores[adjacentTriangles[scratch.adjacency[vertex * 2] + k]] += delta;
+            }
+
+            cacheSize = std::min(newCacheSize, s_vertexCacheSize);
+            memcpy(cache, newCache, cacheSize * sizeof(uint32_t));
+
+            bestTriangle = -1;
+            float bestScore = -1.0f;
+
+            for (uint32_t j = 0; j < cacheSize; j++)
+            {
+                const uint32_t vertex = cache[j];
+
+                for (uint32_t k = 0; k < scratch.adjacency[vertex * 2 + 1]; k++)
+                {
+                    const uint32_t triangle = adjacentTriangles[scratch.adjacency[vertex * 2] + k];
+
+                    if (!scratch.emitted[triangle] && scratch.triangleScores[triangle] > bestScore)
+                    {
+                        bestTriangle = static_cast<int32_t>(triangle);
+                        bestScore = scratch.triangleScores[triangle];
+                    }
+                }
+            }
+        }
+
+        for (const uint32_t vertex : scratch.globalVertices)
+            scratch.localVertices[vertex] = ~0u;
+    }
+}
+
+inline void MeshConversion::reorderTriangles(uint16_t* indices, uint32_t indexCount, const uint8_t* positions,
+    uint32_t positionStride, uint32_t vertexCount, TriangleReorderScratch& scratch)
+{
+    const uint32_t triangleCount = indexCount / 3;
+    if (triangleCount <= 1)
+        return;
+
+    const auto getPosition = [&](uint16_t index, float(&position)[3])
+    {
+        for (uint32_t i = 0; i < 3; i++)
+            position[i] = MeshConversionDetail::loadFloat(positions + static_cast<size_t>(index) * positionStride + i * 4);
+    };
+
+    float minPosition[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float maxPosition[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (uint32_t i = 0; i < triangleCount * 3; i++)
+    {
+        float position[3];
+        getPosition(indices[i], position);
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            if (position[j] < minPosition[j]) minPosition[j] = position[j];
+            if (position[j] > maxPosition[j]) maxPosition[j] = position[j];
+        }
+    }
+
+    float scale[3];
+    for (uint32_t i = 0; i < 3; i++)
+        scale[i] = maxPosition[i] > minPosition[i] ? 1023.0f / (maxPosition[i] - minPosition[i]) : 0.0f;
+
+    // The triangle index in the lower bits keeps the sort stable
+    scratch.keys.resize(triangleCount);
+
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        float centroid[3]{};
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            float position[3];
+            getPosition(indices[i * 3 + j], position);
+
+            for (uint32_t k = 0; k < 3; k++)
+                centroid[k] += position[k] / 3.0f;
+        }
+
+        const uint32_t morton =
+            MeshConversionDetail::expandBits10(MeshConversionDetail::quantizeMorton(centroid[0], minPosition[0], scale[0])) |
+            (MeshConversionDetail::expandBits10(MeshConversionDetail::quantizeMorton(centroid[1], minPosition[1], scale[1])) << 1) |
+            (MeshConversionDetail::expandBits10(MeshConversionDetail::quantizeMorton(centroid[2], minPosition[2], scale[2])) << 2);
+
+        scratch.keys[i] = (static_cast<uint64_t>(morton) << 32) | i;
+    }
+
+    std::sort(scratch.keys.begin(), scratch.keys.end());
+
+    scratch.indices.resize(triangleCount * 3);
+
+    for (uint32_t i = 0; i < triangleCount; i++)
+    {
+        const uint32_t triangle = static_cast<uint32_t>(scratch.keys[i]);
+        memcpy(&scratch.indices[i * 3], &indices[triangle * 3], 3 * sizeof(uint16_t));
+    }
+
+    scratch.localVertices.assign(vertexCount, ~0u);
+
+    for (uint32_t i = 0; i < triangleCount; i += MeshConversionDetail::s_clusterSize)
+    {
+        MeshConversionDetail::optimizeVertexCache(scratch.indices.data() + i * 3,
+            std::min(MeshConversionDetail::s_clusterSize, triangleCount - i), indices + i * 3, scratch);
+    }
+}
@@ -603,20 +603,37 @@ struct MsgSonicInit
 {
     MSG_DEFINE_MESSAGE(MsgComputeGrassInstancer);
 
+    struct Bone
+    {
+        char name[0x40];
+        float inverseBindMatrix[3][4];
+    };
+
     bool bIsModern;
+    uint32_t boneCount;
+    uint32_t dataSize;
+    uint8_t data[1u];
 };
 
 struct MsgSonicUpdate
 {
     MSG_DEFINE_MESSAGE(MsgSonicInit);
-    
+
+    // Only bones that changed since the previous update are sent,
+    // the matrix is the pose multiplied by the inverse bind matrix.
+    struct Bone
+    {
+        uint8_t index;
+        float matrix[3][4];
+    };
+
     bool bIsSuper;
 
     float matrix[16];
 
-    int boneCount = 0;
-    char boneNames[0xFF][0x40];
-    float boneMatrices[0xFF][0x10];
+    uint32_t boneCount;
+    uint32_t dataSize;
+    uint8_t data[1u];
 };
 
 struct MsgCameraUpdate
@@ -639,4 +656,188 @@ struct MsgCameraUpdate
     float aspectRatio;
 };
 
+struct MsgPayloadFence
+{
+    MSG_DEFINE_MESSAGE(MsgCameraUpdate);
+    uint32_t batchIndex;
+};
+
+struct MsgMakeTextureFromHeap
+{
+    MSG_DEFINE_MESSAGE(MsgPayloadFence);
+    uint32_t textureId;
+    uint32_t payloadOffset;
+    uint32_t payloadSize;
+};
+
+struct MsgWriteVertexBufferFromHeap
+{
+    MSG_DEFINE_MESSAGE(MsgMakeTextureFromHeap);
+    uint32_t vertexBufferId;
+    uint32_t offset;
+    bool initialWrite;
+    uint32_t payloadOffset;
+    uint32_t payloadSize;
+};
+
+struct MsgWriteIndexBufferFromHeap
+{
+    MSG_DEFINE_MESSAGE(MsgWriteVertexBufferFromHeap);
+    uint32_t indexBufferId;
+    uint32_t offset;
+    bool initialWrite;
+    uint32_t payloadOffset;
+    uint32_t payloadSize;
+};
+
+// LZ4 block compressed variants, data holds dataSize compressed bytes
+struct MsgMakeTextureCompressed
+{
+    MSG_DEFINE_MESSAGE(MsgWriteIndexBufferFromHeap);
+    uint32_t textureId;
+    uint32_t uncompressedSize;
+    uint32_t dataSize;
+    uint8_t data[1u];
+};
+
+struct MsgWriteVertexBufferCompressed
+{
+    MSG_DEFINE_MESSAGE(MsgMakeTextureCompressed);
+    uint32_t vertexBufferId;
+    uint32_t offset;
+    bool initialWrite;
+    uint32_t uncompressedSize;
+    uint32_t dataSize;
+    uint8_t data[1u];
+};
+
+struct MsgWriteIndexBufferCompressed
+{
+    MSG_DEFINE_MESSAGE(MsgWriteVertexBufferCompressed);
+    uint32_t indexBufferId;
+    uint32_t offset;
+    bool initialWrite;
+    uint32_t uncompressedSize;
+    uint32_t dataSize;
+    uint8_t data[1u];
+};
+
+// Only contains the states that differ from the current ones, data holds
+// the render states, followed by the sampler states, followed by the textures
+struct MsgApplyStateBlock
+{
+    MSG_DEFINE_MESSAGE(MsgWriteIndexBufferCompressed);
+
+    struct RenderState
+    {
+        uint8_t state;
+        uint32_t value;
+    };
+
+    struct SamplerState
+    {
+        uint8_t sampler;
+        uint8_t type;
+        uint32_t value;
+    };
+
+    struct Texture
+    {
+        uint8_t stage;
+        uint32_t textureId;
+    };
+
+    uint8_t renderStateCount;
+    uint8_t samplerStateCount;
+    uint8_t textureCount;
+    uint16_t dataSize;
+    uint8_t data[1u];
+};
+
+// Consecutive indexed draws with the same bound state, data holds the draws
+struct MsgDrawIndexedPrimitives
+{
+    MSG_DEFINE_MESSAGE(MsgApplyStateBlock);
+
+    struct Draw
+    {
+        int32_t baseVertexIndex;
+        uint32_t startIndex;
+        uint32_t indexCount;
+    };
+
+    uint8_t primitiveType;
+    uint32_t dataSize;
+    uint8_t data[1u];
+};
+
+// Sub-rectangle of a texture level, in texels, aligned to the format's block size
+struct MsgWriteTextureRegion
+{
+    MSG_DEFINE_MESSAGE(MsgDrawIndexedPrimitives);
+    uint32_t textureId;
+    uint32_t level;
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;
+    uint32_t dataSize;
+    alignas(0x10) uint8_t data[1u];
+};
+
+// Shaders listed in the shader manifest, the bridge loads the bytecode from disk
+struct MsgCreateVertexShaderFromCache
+{
+    MSG_DEFINE_MESSAGE(MsgWriteTextureRegion);
+    uint32_t vertexShaderId;
+    uint64_t hash;
+};
+
+struct MsgCreatePixelShaderFromCache
+{
+    MSG_DEFINE_MESSAGE(MsgCreateVertexShaderFromCache);
+    uint32_t pixelShaderId;
+    uint64_t hash;
+};
+
+// Shared heap that small vertex and index buffers get suballocated from
+struct MsgCreateBufferHeap
+{
+    MSG_DEFINE_MESSAGE(MsgCreatePixelShaderFromCache);
+    uint32_t heapId;
+    uint32_t length;
+};
+
+struct MsgCreateVertexBufferInHeap
+{
+    MSG_DEFINE_MESSAGE(MsgCreateBufferHeap);
+    uint32_t length;
+    uint32_t vertexBufferId;
+    uint32_t heapId;
+    uint32_t offset;
+};
+
+struct MsgCreateIndexBufferInHeap
+{
+    MSG_DEFINE_MESSAGE(MsgCreateVertexBufferInHeap);
+    uint32_t length;
+    uint32_t format;
+    uint32_t indexBufferId;
+    uint32_t heapId;
+    uint32_t offset;
+};
+
+// Part of a DDS file too large for both a batch and the payload heap. Parts arrive
+// in order, the bridge makes the texture once it has received the total size.
+struct MsgMakeTexturePart
+{
+    MSG_DEFINE_MESSAGE(MsgCreateIndexBufferInHeap);
+    uint32_t textureId;
+    uint32_t totalSize;
+    uint32_t offset;
+    uint32_t dataSize;
+    alignas(0x10) uint8_t data[1u];
+};
+
 #pragma pack(pop)
\ No newline at end of file
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+#include "Message.h"
+
+// Describes the layout of every message in Message.h, so that a command stream
+// can be walked without decoding the messages. Keep this table in sync when
+// adding new messages, the static assert below catches a missing entry.
+struct MessageInfo
+{
+    uint32_t id;
+    const char* name;
+    uint32_t headerSize;     // sizeof for fixed size messages, offset of data otherwise
+    uint32_t dataSizeOffset; // 0 for fixed size messages
+    uint32_t dataSizeBytes;
+
+    bool isVariableSize() const;
+    uint32_t getByteSize(const void* message) const;
+
+    static const MessageInfo* get(uint32_t id);
+};
+
+// GCC and Clang ignore alignas on members of packed structs, so the data offset
+// gets realigned to match the layout produced by MSVC.
+#define MSG_INFO_FIXED(T) \
+    { T::s_id, #T, sizeof(T), 0, 0 }
+
+#define MSG_INFO_VARIABLE(T, DATA_ALIGNMENT) \
+    { T::s_id, #T, (offsetof(T, data) + (DATA_ALIGNMENT) - 1) & ~((DATA_ALIGNMENT) - 1), offsetof(T, dataSize), sizeof(T::dataSize) }
+
+inline constexpr MessageInfo s_messageInfos[] =
+{
+    MSG_INFO_VARIABLE(MsgPadding, 1),
+    MSG_INFO_FIXED(MsgCreateSwapChain),
+    MSG_INFO_FIXED(MsgSetRenderTarget),
+    MSG_INFO_VARIABLE(MsgCreateVertexDeclaration, 1),
+    MSG_INFO_VARIABLE(MsgCreatePixelShader, 0x10),
+    MSG_INFO_VARIABLE(MsgCreateVertexShader, 0x10),
+    MSG_INFO_FIXED(MsgSetRenderState),
+    MSG_INFO_FIXED(MsgCreateTexture),
+    MSG_INFO_FIXED(MsgSetTexture),
+    MSG_INFO_FIXED(MsgSetDepthStencilSurface),
+    MSG_INFO_FIXED(MsgClear),
+    MSG_INFO_FIXED(MsgSetVertexShader),
+    MSG_INFO_FIXED(MsgSetPixelShader),
+    MSG_INFO_VARIABLE(MsgSetPixelShaderConstantF, 1),
+    MSG_INFO_VARIABLE(MsgSetVertexShaderConstantF, 1),
+    MSG_INFO_VARIABLE(MsgSetVertexShaderConstantB, 1),
+    MSG_INFO_FIXED(MsgSetSamplerState),
+    MSG_INFO_FIXED(MsgSetViewport),
+    MSG_INFO_FIXED(MsgSetScissorRect),
+    MSG_INFO_FIXED(MsgSetVertexDeclaration),
+    MSG_INFO_VARIABLE(MsgDrawPrimitiveUP, 1),
+    MSG_INFO_FIXED(MsgSetStreamSource),
+    MSG_INFO_FIXED(MsgSetIndices),
+    MSG_INFO_FIXED(MsgPresent),
+    MSG_INFO_FIXED(MsgCreateVertexBuffer),
+    MSG_INFO_VARIABLE(MsgWriteVertexBuffer, 0x10),
+    MSG_INFO_FIXED(MsgCreateIndexBuffer),
+    MSG_INFO_VARIABLE(MsgWriteIndexBuffer, 0x10),
+    MSG_INFO_VARIABLE(MsgWriteTexture, 0x10),
+    MSG_INFO_VARIABLE(MsgMakeTexture, 0x10),
+    MSG_INFO_FIXED(MsgDrawIndexedPrimitive),
+    MSG_INFO_FIXED(MsgSetStreamSourceFreq),
+    MSG_INFO_FIXED(MsgReleaseResource),
+    MSG_INFO_FIXED(MsgDrawPrimitive),
+    MSG_INFO_VARIABLE(MsgCreateBottomLevelAccelStruct, 1),
+    MSG_INFO_FIXED(MsgReleaseRaytracingResource),
+    MSG_INFO_VARIABLE(MsgCreateInstance, 1),
+    MSG_INFO_FIXED(MsgTraceRays),
+    MSG_INFO_FIXED(MsgCreateMaterial),
+    MSG_INFO_VARIABLE(MsgComputePose, 1),
+    MSG_INFO_FIXED(MsgBuildBottomLevelAccelStruct),
+    MSG_INFO_FIXED(MsgCopyVertexBuffer),
+    MSG_INFO_VARIABLE(MsgRenderSky, 1),
+    MSG_INFO_FIXED(MsgCreateLocalLight),
+    MSG_INFO_VARIABLE(MsgSetPixelShaderConstantB, 1),
+    MSG_INFO_FIXED(MsgSaveShaderCache),
+    MSG_INFO_FIXED(MsgComputeSmoothNormal),
+    MSG_INFO_VARIABLE(MsgDrawIndexedPrimitiveUP, 1),
+    MSG_INFO_FIXED(MsgShowCursor),
+    MSG_INFO_FIXED(MsgDispatchUpscaler),
+    MSG_INFO_VARIABLE(MsgDrawIm3d, 1),
+    MSG_INFO_FIXED(MsgCopyHdrTexture),
+    MSG_INFO_VARIABLE(MsgComputeGrassInstancer, 1),
+    MSG_INFO_VARIABLE(MsgSonicInit, 1),
+    MSG_INFO_VARIABLE(MsgSonicUpdate, 1),
+    MSG_INFO_FIXED(MsgCameraUpdate),
+    MSG_INFO_FIXED(MsgPayloadFence),
+    MSG_INFO_FIXED(MsgMakeTextureFromHeap),
+    MSG_INFO_FIXED(MsgWriteVertexBufferFromHeap),
+    MSG_INFO_FIXED(MsgWriteIndexBufferFromHeap),
+    MSG_INFO_VARIABLE(MsgMakeTextureCompressed, 1),
+    MSG_INFO_VARIABLE(MsgWriteVertexBufferCompressed, 1),
+    MSG_INFO_VARIABLE(MsgWriteIndexBufferCompressed, 1),
+    MSG_INFO_VARIABLE(MsgApplyStateBlock, 1),
+    MSG_INFO_VARIABLE(MsgDrawIndexedPrimitives, 1),
+    MSG_INFO_VARIABLE(MsgWriteTextureRegion, 0x10),
+    MSG_INFO_FIXED(MsgCreateVertexShaderFromCache),
+    MSG_INFO_FIXED(MsgCreatePixelShaderFromCache),
+    MSG_INFO_FIXED(MsgCreateBufferHeap),
+    MSG_INFO_FIXED(MsgCreateVertexBufferInHeap),
+    MSG_INFO_FIXED(MsgCreateIndexBufferInHeap),
+    MSG_INFO_VARIABLE(MsgMakeTexturePart, 0x10),
+};
+
+#undef MSG_INFO_FIXED
+#undef MSG_INFO_VARIABLE
+
+static_assert(std::size(s_messageInfos) == MsgMakeTexturePart::s_id + 1, "Message info table is out of date");
+
+static_assert([]
+{
+    for (uint32_t i = 0; i < std::size(s_messageInfos); i++)
+    {
+        if (s_messageInfos[i].id != i)
+            return false;
+    }
+    return true;
+}(), "Message info table is not ordered by id");
+
+#include "MessageInfo.inl"
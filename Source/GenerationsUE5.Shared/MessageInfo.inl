@@ -0,0 +1,23 @@
+inline bool MessageInfo::isVariableSize() const
+{
+    return dataSizeBytes != 0;
+}
+
+inline uint32_t MessageInfo::getByteSize(const void* message) const
+{
+    if (!isVariableSize())
+        return headerSize;
+
+    const uint8_t* dataSize = static_cast<const uint8_t*>(message) + dataSizeOffset;
+    uint32_t value = 0;
+
+    for (uint32_t i = 0; i < dataSizeBytes; i++)
+        value |= static_cast<uint32_t>(dataSize[i]) << (i * 8);
+
+    return headerSize + value;
+}
+
+inline const MessageInfo* MessageInfo::get(uint32_t id)
+{
+    return id < std::size(s_messageInfos) ? &s_messageInfos[id] : nullptr;
+}
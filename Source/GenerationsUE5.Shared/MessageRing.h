@@ -0,0 +1,31 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Header of the zero-copy transport mapping. The x86 process writes messages
+// directly into the slots following this header and publishes a slot by advancing
+// the producer cursor. The bridge reads published slots in place and advances
+// the consumer cursor once it's done with them, then signals the GPU event.
+// Every slot has the same layout as the copied buffer of the legacy transport.
+struct MessageRingHeader
+{
+    static constexpr TCHAR s_name[] = TEXT("GenerationsUE5MessageRing");
+    static constexpr uint32_t s_minSlotCount = 2;
+    static constexpr uint32_t s_maxSlotCount = 4;
+
+    uint32_t slotCount;
+    uint32_t slotSize;
+    alignas(0x40) std::atomic<uint32_t> producerCursor;
+    alignas(0x40) std::atomic<uint32_t> consumerCursor;
+
+    static constexpr size_t getMappingSize(uint32_t slotCount, uint32_t slotSize);
+
+    uint8_t* getSlot(uint32_t cursor);
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+#include "MessageRing.inl"
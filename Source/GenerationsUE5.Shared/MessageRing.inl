@@ -0,0 +1,9 @@
+constexpr size_t MessageRingHeader::getMappingSize(uint32_t slotCount, uint32_t slotSize)
+{
+    return sizeof(MessageRingHeader) + static_cast<size_t>(slotCount) * slotSize;
+}
+
+inline uint8_t* MessageRingHeader::getSlot(uint32_t cursor)
+{
+    return reinterpret_cast<uint8_t*>(this + 1) + static_cast<size_t>(cursor % slotCount) * slotSize;
+}
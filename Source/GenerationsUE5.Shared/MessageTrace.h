@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// Layout of the .gensrt files written by the capture mode of MessageSender.
+// The header is followed by frames, each holding a batch exactly as it was
+// committed, including the size header at the start of the batch.
+struct MessageTraceHeader
+{
+    static constexpr uint32_t s_magic = 0x54525347; // GSRT
+    static constexpr uint32_t s_version = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t messageCount; // Number of message types known to the writer
+    uint32_t debugLayout;  // Written by a debug build, see MsgMakeTexture
+};
+
+struct MessageTraceFrame
+{
+    uint32_t frameIndex;
+    uint32_t byteSize;
+};
@@ -1,9 +1,21 @@
 #pragma once
 
-#include <Windows.h>
+#include "Platform.h"
 
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+
+#ifdef _WIN32
 class Mutex : protected CRITICAL_SECTION
 {
+#else
+class Mutex
+{
+protected:
+    pthread_mutex_t m_mutex;
+
+#endif
 public:
     Mutex();
     ~Mutex();
@@ -15,4 +27,4 @@ public:
     void unlock();
 };
 
-#include "Mutex.inl"
\ No newline at end of file
+#include "Mutex.inl"
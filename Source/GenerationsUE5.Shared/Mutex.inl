@@ -1,3 +1,5 @@
+#ifdef _WIN32
+
 inline Mutex::Mutex()
 {
     InitializeCriticalSection(this);
@@ -18,4 +20,36 @@ inline void Mutex::unlock()
     LeaveCriticalSection(this);
 }
 
+#else
+
+#include <cassert>
+
+inline Mutex::Mutex()
+{
+    // Critical sections are recursive
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+
+    [[maybe_unused]] const int result = pthread_mutex_init(&m_mutex, &attr);
+    assert(result == 0);
+
+    pthread_mutexattr_destroy(&attr);
+}
+
+inline Mutex::~Mutex()
+{
+    pthread_mutex_destroy(&m_mutex);
+}
+
+inline void Mutex::lock()
+{
+    pthread_mutex_lock(&m_mutex);
+}
+
+inline void Mutex::unlock()
+{
+    pthread_mutex_unlock(&m_mutex);
+}
 
+#endif
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Header of the mapping that holds large payloads out of the command stream.
+// Messages reference payloads by their offset into the data following this header.
+// Every batch that references the heap ends with MsgPayloadFence; once the bridge
+// is done with the batch, it stores its index + 1 to the consumed batch counter,
+// which lets the x86 process reuse the memory.
+struct PayloadHeapHeader
+{
+    static constexpr TCHAR s_name[] = TEXT("GenerationsUE5PayloadHeap");
+
+    uint32_t capacity;
+    alignas(0x40) std::atomic<uint32_t> consumedBatch;
+
+    uint8_t* getData();
+};
+
+#include "PayloadHeapHeader.inl"
@@ -0,0 +1,4 @@
+inline uint8_t* PayloadHeapHeader::getData()
+{
+    return reinterpret_cast<uint8_t*>(this + 1);
+}
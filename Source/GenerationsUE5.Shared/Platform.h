@@ -0,0 +1,25 @@
+#pragma once
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+#else
+
+// Just enough of the Win32 types for the transport primitives to keep
+// the same interface when they get built against POSIX.
+using BOOL = int;
+using TCHAR = char;
+using LPCTSTR = const char*;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#define TEXT(x) x
+
+#endif
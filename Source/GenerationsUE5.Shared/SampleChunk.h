@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+// Hedgehog Engine resource containers. Every value is big-endian, and pointers are
+// offsets that get relocated to absolute little-endian addresses when loading.
+
+struct SampleChunkHeaderV1
+{
+    uint32_t fileSize;
+    uint32_t version;
+    uint32_t dataSize;
+    uint32_t data;
+    uint32_t relocationTable;
+    uint32_t fileName;
+};
+
+// Offsets are relative to the end of the header, except for the relocation table.
+// The most significant bit of the file size tells it apart from the V1 header.
+struct SampleChunkHeaderV2
+{
+    static constexpr uint32_t s_flag = 0x80000000;
+
+    uint32_t fileSize;
+    uint32_t version;
+    uint32_t relocationTable;
+    uint32_t offsetCount;
+};
+
+// Nodes follow the V2 header until the contexts node, which holds the
+// version of the data that comes right after it.
+struct SampleChunkNode
+{
+    static constexpr char s_contexts[8] = { 'C', 'o', 'n', 't', 'e', 'x', 't', 's' };
+    static constexpr char s_gensRT[8] = { 'G', 'e', 'n', 's', 'R', 'T', ' ', ' ' };
+    static constexpr char s_topology[8] = { 'T', 'o', 'p', 'o', 'l', 'o', 'g', 'y' };
+    static constexpr char s_adjacencyTable[8] = { 'A', 'd', 'j', 'T', 'a', 'b', 'l', 'e' };
+
+    // GensRT node value of meshes in the optimized vertex format
+    static constexpr uint32_t s_optimizedVertexFormat = 1;
+    // Topology node value of meshes with triangle list indices
+    static constexpr uint32_t s_triangleList = 3;
+
+    uint32_t flagsAndSize;
+    uint32_t value;
+    char name[8];
+};
+
+// Precomputed vertex to triangle adjacency of smooth normal meshes, pointed to by
+// the adjacency table node. The data is little-endian, in the exact layout the bridge takes.
+struct SampleChunkAdjacency
+{
+    uint32_t mesh;
+    uint32_t data;
+    uint32_t byteSize;
+};
+
+// Followed by the adjacency entries
+struct SampleChunkAdjacencyTable
+{
+    uint32_t count;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Platform.h"
+
+#include <atomic>
+#include <cstdint>
+
+// Header of the mapping the bridge reports shader cache misses through. When a
+// shader created from its hash alone has no bytecode on disk, the bridge pushes its
+// id and hash here and skips draws using it. The x86 process pops misses once per
+// frame and sends the bytecode with the regular create message, reusing the same id.
+// Misses whose hash no longer matches the shader behind the id get dropped.
+//
+// The producer never overwrites misses that weren't consumed yet. If the ring is
+// full, it drops the miss and sets the overflow flag instead, and the consumer
+// resyncs by resending the bytecode of every shader it created from the cache.
+struct ShaderCacheMissRingHeader
+{
+    static constexpr TCHAR s_name[] = TEXT("GenerationsUE5ShaderCacheMissRing");
+    static constexpr uint32_t s_capacity = 1024;
+
+    struct Miss
+    {
+        uint64_t hash;
+        uint32_t shaderId;
+        uint32_t isPixelShader;
+    };
+
+    alignas(0x40) std::atomic<uint32_t> producerCursor;
+    std::atomic<uint32_t> overflowed;
+    alignas(0x40) std::atomic<uint32_t> consumerCursor;
+    Miss misses[s_capacity];
+};
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
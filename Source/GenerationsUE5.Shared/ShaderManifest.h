@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hashes of the shaders the bridge keeps the bytecode of on disk, next to its
+// pipeline cache. The bridge rewrites the file whenever it saves the shader cache,
+// the x86 process reads it at startup to decide which shaders can be created
+// from their hash alone. Both processes share the working directory.
+struct ShaderManifest
+{
+    static constexpr char s_filePath[] = "GenerationsUE5ShaderManifest.bin";
+    static constexpr uint32_t s_signature = 0x464E4D53; // SMNF
+    static constexpr uint32_t s_version = 1;
+
+    struct Header
+    {
+        uint32_t signature;
+        uint32_t version;
+        uint32_t hashCount;
+    };
+
+    static uint64_t computeHash(const void* function, size_t functionSize);
+
+    // Returns the hashes sorted, or nothing if the file is missing or out of date
+    static std::vector<uint64_t> load(const char* filePath);
+    static bool save(const char* filePath, std::vector<uint64_t> hashes);
+};
+
+#include "ShaderManifest.inl"
@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <cstdio>
+
+#include <xxhash.h>
+
+inline uint64_t ShaderManifest::computeHash(const void* function, size_t functionSize)
+{
+    return XXH64(function, functionSize, 0);
+}
+
+inline std::vector<uint64_t> ShaderManifest::load(const char* filePath)
+{
+    std::vector<uint64_t> hashes;
+
+    FILE* file = fopen(filePath, "rb");
+    if (file == nullptr)
+        return hashes;
+
+    Header header{};
+    if (fread(&header, sizeof(header), 1, file) == 1 && header.signature == s_signature && header.version == s_version)
+    {
+        hashes.resize(header.hashCount);
+
+        if (fread(hashes.data(), sizeof(uint64_t), hashes.size(), file) == hashes.size())
+            std::sort(hashes.begin(), hashes.end());
+        else
+            hashes.clear();
+    }
+
+    fclose(file);
+
+    return hashes;
+}
+
+inline bool ShaderManifest::save(const char* filePath, std::vector<uint64_t> hashes)
+{
+    std::sort(hashes.begin(), hashes.end());
+    hashes.erase(std::unique(hashes.begin(), hashes.end()), hashes.end());
+
+    FILE* file = fopen(filePath, "wb");
+    if (file == nullptr)
+        return false;
+
+    const Header header = { s_signature, s_version, static_cast<uint32_t>(hashes.size()) };
+
+    const bool result = fwrite(&header, sizeof(header), 1, file) == 1 &&
+        fwrite(hashes.data(), sizeof(uint64_t), hashes.size(), file) == hashes.size();
+
+    fclose(file);
+
+    return result;
+}
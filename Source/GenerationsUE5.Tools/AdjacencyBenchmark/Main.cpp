@@ -0,0 +1,119 @@
+#include <MeshConversion.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+// Compares the counting sort adjacency builder against the vector per vertex
+// builder it replaced, on grid meshes with shuffled vertices like the ones the
+// exporters produce. Both have to produce the exact same adjacency data.
+// Usage: AdjacencyBenchmark [repeat count]
+
+using Clock = std::chrono::steady_clock;
+
+static void generateAdjacencyVectors(uint32_t vertexCount, const std::vector<uint32_t>& indices, std::vector<uint32_t>& adjacency)
+{
+    std::vector<std::vector<uint32_t>> adjacentTriangles(vertexCount);
+
+    for (size_t i = 0; i < indices.size(); i++)
+        adjacentTriangles[indices[i]].push_back(static_cast<uint32_t>(i / 3));
+
+    size_t adjacentIndexNum = 0;
+    for (const auto& adjacencyIndices : adjacentTriangles)
+        adjacentIndexNum += adjacencyIndices.size();
+
+    adjacency.resize(adjacentTriangles.size() * 2 + adjacentIndexNum);
+
+    auto metaCursor = adjacency.data();
+    auto indexCursor = metaCursor + adjacentTriangles.size() * 2;
+
+    uint32_t curIndex = 0;
+
+    for (const auto& adjacencyIndices : adjacentTriangles)
+    {
+        *metaCursor = curIndex;
+        *(metaCursor + 1) = static_cast<uint32_t>(adjacencyIndices.size());
+        metaCursor += 2;
+
+        memcpy(indexCursor, adjacencyIndices.data(), adjacencyIndices.size() * sizeof(uint32_t));
+        indexCursor += adjacencyIndices.size();
+        curIndex += static_cast<uint32_t>(adjacencyIndices.size());
+    }
+}
+
+static void makeGrid(uint32_t size, std::vector<uint32_t>& indices)
+{
+    std::vector<uint32_t> remap(size * size);
+    for (uint32_t i = 0; i < remap.size(); i++)
+        remap[i] = i;
+
+    std::shuffle(remap.begin(), remap.end(), std::mt19937(size));
+
+    indices.clear();
+
+    for (uint32_t y = 0; y < size - 1; y++)
+    {
+        for (uint32_t x = 0; x < size - 1; x++)
+        {
+            const uint32_t a = remap[y * size + x];
+            const uint32_t b = remap[y * size + x + 1];
+            const uint32_t c = remap[(y + 1) * size + x];
+            const uint32_t d = remap[(y + 1) * size + x + 1];
+
+            indices.insert(indices.end(), { a, b, c, c, b, d });
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t repeatCount = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 5;
+
+    if (repeatCount == 0)
+    {
+        printf("Repeat count needs to be at least 1\n");
+        return 1;
+    }
+
+    printf("%-10s %10s %14s %14s %9s\n", "Vertices", "Triangles", "Vectors", "Counting sort", "Speedup");
+
+    bool matches = true;
+
+    for (const uint32_t size : { 100u, 316u, 1000u })
+    {
+        std::vector<uint32_t> indices;
+        makeGrid(size, indices);
+
+        const uint32_t vertexCount = size * size;
+        const uint32_t indexCount = static_cast<uint32_t>(indices.size());
+
+        std::vector<uint32_t> reference;
+        std::vector<uint32_t> adjacency(MeshConversion::getAdjacencySize(vertexCount, indexCount));
+
+        double referenceSeconds = 0.0;
+        double countingSortSeconds = 0.0;
+
+        for (uint32_t i = 0; i < repeatCount; i++)
+        {
+            auto begin = Clock::now();
+            generateAdjacencyVectors(vertexCount, indices, reference);
+            referenceSeconds += std::chrono::duration<double>(Clock::now() - begin).count();
+
+            begin = Clock::now();
+            MeshConversion::generateAdjacency(vertexCount, indexCount, [&](uint32_t i) { return indices[i]; }, adjacency.data());
+            countingSortSeconds += std::chrono::duration<double>(Clock::now() - begin).count();
+        }
+
+        const bool match = reference == adjacency;
+        matches &= match;
+
+        printf("%-10u %10u %11.2f ms %11.2f ms %8.1fx %s\n", vertexCount, indexCount / 3,
+            referenceSeconds * 1000.0 / repeatCount, countingSortSeconds * 1000.0 / repeatCount,
+            referenceSeconds / countingSortSeconds, match ? "" : "MISMATCH");
+    }
+
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,217 @@
+#include <FreeListAllocator.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <thread>
+
+// Compares FreeListAllocator and LockFreeListAllocator against the sorted vector
+// free list they replaced. Every allocator has to hand out the exact same indices
+// for the same allocate/free sequence, since the bridge relies on dense ids.
+// Usage: AllocatorBenchmark [live count] [iterations]
+
+class SortedVectorAllocator
+{
+protected:
+    std::vector<uint32_t> m_indices;
+    uint32_t m_capacity = 1;
+    Mutex m_mutex;
+
+public:
+    uint32_t allocate()
+    {
+        LockGuard lock(m_mutex);
+
+        uint32_t index;
+
+        if (!m_indices.empty())
+        {
+            index = m_indices.back();
+            m_indices.pop_back();
+        }
+        else
+        {
+            index = m_capacity;
+            ++m_capacity;
+        }
+
+        return index;
+    }
+
+    void free(uint32_t index)
+    {
+        LockGuard lock(m_mutex);
+        m_indices.insert(std::lower_bound(m_indices.begin(), m_indices.end(), index, std::greater<uint32_t>()), index);
+    }
+};
+
+static constexpr uint32_t s_lockFreeCapacity = 1u << 20;
+
+using Clock = std::chrono::steady_clock;
+
+struct Operation
+{
+    bool allocate;
+    uint32_t slot;
+};
+
+// Fills up to the live count, then frees and allocates random live ids in bursts,
+// the way stage unloads release thousands of resources at once
+static std::vector<Operation> makeOperations(uint32_t liveCount, uint32_t iterations)
+{
+    std::vector<Operation> operations;
+    std::mt19937 random(0);
+
+    for (uint32_t i = 0; i < liveCount; i++)
+        operations.push_back({ true, i });
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const uint32_t burst = 1 + random() % (liveCount / 2);
+        std::vector<uint32_t> slots(burst);
+
+        for (auto& slot : slots)
+        {
+            slot = random() % liveCount;
+            operations.push_back({ false, slot });
+        }
+
+        for (const auto slot : slots)
+            operations.push_back({ true, slot });
+    }
+
+    return operations;
+}
+
+template<typename T>
+static double run(T& allocator, const std::vector<Operation>& operations, uint32_t liveCount, std::vector<uint32_t>& results)
+{
+    // A slot can get freed twice in the same burst, only free what's live
+    std::vector<uint32_t> slots(liveCount, 0);
+    results.clear();
+    results.reserve(operations.size());
+
+    const auto begin = Clock::now();
+
+    for (const auto& operation : operations)
+    {
+        uint32_t& slot = slots[operation.slot];
+
+        if (operation.allocate)
+        {
+            if (slot == 0)
+            {
+                slot = allocator.allocate();
+                results.push_back(slot);
+            }
+        }
+        else if (slot != 0)
+        {
+            allocator.free(slot);
+            slot = 0;
+        }
+    }
+
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+// Every thread churns its own ids, no index may be handed out twice at a time
+static bool runThreaded(LockFreeListAllocator<s_lockFreeCapacity>& allocator, uint32_t threadCount, uint32_t iterations)
+{
+    auto owners = std::make_unique<std::atomic<uint32_t>[]>(s_lockFreeCapacity);
+    std::atomic<bool> failed = false;
+    std::vector<std::thread> threads;
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&, i]
+        {
+            std::mt19937 random(i);
+            std::vector<uint32_t> indices;
+
+            for (uint32_t j = 0; j < iterations; j++)
+            {
+                if (indices.empty() || random() % 2 == 0)
+                {
+                    const uint32_t index = allocator.allocate();
+                    if (owners[index].exchange(i + 1) != 0)
+                        failed = true;
+
+                    indices.push_back(index);
+                }
+                else
+                {
+                    const uint32_t slot = random() % indices.size();
+                    owners[indices[slot]].store(0);
+                    allocator.free(indices[slot]);
+                    indices[slot] = indices.back();
+                    indices.pop_back();
+                }
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    return !failed;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t liveCount = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 50000;
+    const uint32_t iterations = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 200;
+
+    if (liveCount < 2 || liveCount >= s_lockFreeCapacity)
+    {
+        printf("Live count needs to be between 2 and %u\n", s_lockFreeCapacity - 1);
+        return 1;
+    }
+
+    const auto operations = makeOperations(liveCount, iterations);
+
+    std::vector<uint32_t> referenceResults;
+    std::vector<uint32_t> results;
+
+    auto sortedVectorAllocator = std::make_unique<SortedVectorAllocator>();
+    const double referenceSeconds = run(*sortedVectorAllocator, operations, liveCount, referenceResults);
+
+    printf("%zu operations, %u live ids\n\n", operations.size(), liveCount);
+    printf("%-24s %10.2f ms\n", "Sorted vector", referenceSeconds * 1000.0);
+
+    bool matches = true;
+
+    auto freeListAllocator = std::make_unique<FreeListAllocator>();
+    const double freeListSeconds = run(*freeListAllocator, operations, liveCount, results);
+    printf("%-24s %10.2f ms %8.1fx %s\n", "Hierarchical bitmap", freeListSeconds * 1000.0,
+        referenceSeconds / freeListSeconds, results == referenceResults ? "" : "MISMATCH");
+    matches &= results == referenceResults;
+
+    auto lockFreeAllocator = std::make_unique<LockFreeListAllocator<s_lockFreeCapacity>>();
+    const double lockFreeSeconds = run(*lockFreeAllocator, operations, liveCount, results);
+    printf("%-24s %10.2f ms %8.1fx %s\n", "Lock-free bitmap", lockFreeSeconds * 1000.0,
+        referenceSeconds / lockFreeSeconds, results == referenceResults ? "" : "MISMATCH");
+    matches &= results == referenceResults;
+
+    auto threadedAllocator = std::make_unique<LockFreeListAllocator<s_lockFreeCapacity>>();
+    const bool threadedResult = runThreaded(*threadedAllocator, 4, 200000);
+    printf("\nLock-free bitmap on 4 threads: %s\n", threadedResult ? "OK" : "DUPLICATE INDEX");
+
+    // Runs past the capacity, the overflow ids need to stay unique and get reused
+    auto smallAllocator = std::make_unique<LockFreeListAllocator<1024>>();
+    std::vector<uint32_t> indices;
+    for (uint32_t i = 0; i < 1500; i++)
+        indices.push_back(smallAllocator->allocate());
+
+    smallAllocator->free(indices[1200]);
+    bool overflowResult = smallAllocator->allocate() == indices[1200];
+
+    std::sort(indices.begin(), indices.end());
+    overflowResult &= indices.front() == 1 && indices.back() == 1500 && std::adjacent_find(indices.begin(), indices.end()) == indices.end();
+    printf("Lock-free bitmap past its capacity: %s\n", overflowResult ? "OK" : "DUPLICATE INDEX");
+
+    return matches && threadedResult && overflowResult ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+#include <Configuration.h>
+#include <Event.h>
+#include <MemoryMappedFile.h>
+#include <Message.h>
+#include <MessageInfo.h>
+#include <MessageRing.h>
+#include <MessageSender.h>
+#include <PayloadHeapHeader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+#include <vector>
+
+// Stand-in for the x64 bridge, drains batches through the same handshake so that
+// the transport can be load tested without the game or Unreal. The produce mode
+// drives the game's MessageSender to generate the load.
+//
+// Usage:
+//   BridgeStandIn consume [--ring] [--payload-heap]
+//   BridgeStandIn produce [--ring <slots>] [--commit-thread <depth>] [--batches <count>] [--batch-size <bytes>] [--message-size <bytes>]
+//
+// A batch without messages tells the consumer to exit, start the consumer first.
+
+using Clock = std::chrono::high_resolution_clock;
+
+static double getMilliseconds(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+static const char* findOption(int argc, char* argv[], const char* name)
+{
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+            return i + 1 < argc ? argv[i + 1] : "";
+    }
+    return nullptr;
+}
+
+static uint32_t getOption(int argc, char* argv[], const char* name, uint32_t defaultValue)
+{
+    const char* value = findOption(argc, argv, name);
+    return value != nullptr && *value != '\0' ? static_cast<uint32_t>(strtoul(value, nullptr, 0)) : defaultValue;
+}
+
+struct ConsumerStats
+{
+    uint64_t batchCount;
+    uint64_t messageCount;
+    uint64_t byteSize;
+};
+
+// Walks a batch like the bridge does, returns false on a malformed stream
+static bool consumeBatch(const uint8_t* messages, uint32_t byteSize, PayloadHeapHeader* payloadHeap, ConsumerStats& stats)
+{
+    uint32_t offset = sizeof(uint32_t);
+
+    while (offset < byteSize)
+    {
+        const uint8_t id = messages[offset];
+        const MessageInfo* info = MessageInfo::get(id);
+
+        if (info == nullptr)
+        {
+            fprintf(stderr, "Unknown message id %u at offset 0x%X\n", id, offset);
+            return false;
+        }
+
+        const uint32_t messageSize = info->getByteSize(messages + offset);
+        if (offset + messageSize > byteSize)
+        {
+            fprintf(stderr, "%s at offset 0x%X overruns the batch\n", info->name, offset);
+            return false;
+        }
+
+        if (id == MsgPayloadFence::s_id && payloadHeap != nullptr)
+        {
+            uint32_t batchIndex;
+            memcpy(&batchIndex, messages + offset + offsetof(MsgPayloadFence, batchIndex), sizeof(batchIndex));
+            payloadHeap->consumedBatch.store(batchIndex + 1, std::memory_order_release);
+        }
+
+        if (id != MsgPadding::s_id)
+            ++stats.messageCount;
+
+        offset += messageSize;
+    }
+
+    ++stats.batchCount;
+    stats.byteSize += byteSize;
+
+    return true;
+}
+
+static int consume(int argc, char* argv[])
+{
+    const bool useRing = findOption(argc, argv, "--ring") != nullptr;
+    const bool usePayloadHeap = findOption(argc, argv, "--payload-heap") != nullptr;
+
+    Event cpuEvent(Event::s_cpuEventName, FALSE);
+    Event gpuEvent(Event::s_gpuEventName, TRUE);
+
+    std::optional<MemoryMappedFile> payloadHeapFile;
+    PayloadHeapHeader* payloadHeap = nullptr;
+
+    if (usePayloadHeap)
+    {
+        payloadHeapFile.emplace(PayloadHeapHeader::s_name, sizeof(PayloadHeapHeader));
+        payloadHeap = static_cast<PayloadHeapHeader*>(payloadHeapFile->map());
+    }
+
+    ConsumerStats stats{};
+    ConsumerStats prevStats{};
+    auto prevTime = Clock::now();
+    bool success = true;
+
+    auto report = [&]
+    {
+        const auto time = Clock::now();
+        const double seconds = getMilliseconds(prevTime, time) / 1000.0;
+
+        if (seconds < 1.0)
+            return;
+
+        printf("%.1f batches/s, %.1f messages/s, %.1f MB/s\n",
+            static_cast<double>(stats.batchCount - prevStats.batchCount) / seconds,
+            static_cast<double>(stats.messageCount - prevStats.messageCount) / seconds,
+            static_cast<double>(stats.byteSize - prevStats.byteSize) / (1024.0 * 1024.0 * seconds));
+
+        prevStats = stats;
+        prevTime = time;
+    };
+
+    if (useRing)
+    {
+        std::optional<MemoryMappedFile> file;
+        MessageRingHeader* ring = nullptr;
+
+        bool exit = false;
+        while (!exit && success)
+        {
+            cpuEvent.wait();
+            cpuEvent.reset();
+
+            // The producer sets up the ring before publishing the first slot
+            if (ring == nullptr)
+            {
+                file.emplace(MessageRingHeader::s_name, sizeof(MessageRingHeader));
+                ring = static_cast<MessageRingHeader*>(file->map());
+            }
+
+            uint32_t consumerCursor = ring->consumerCursor.load(std::memory_order_relaxed);
+            const uint32_t producerCursor = ring->producerCursor.load(std::memory_order_acquire);
+
+            while (consumerCursor != producerCursor)
+            {
+                const uint8_t* messages = ring->getSlot(consumerCursor);
+                const uint32_t byteSize = *reinterpret_cast<const uint32_t*>(messages);
+
+                if (byteSize <= sizeof(uint32_t))
+                    exit = true;
+                else
+                    success = consumeBatch(messages, byteSize, payloadHeap, stats);
+
+                ++consumerCursor;
+                ring->consumerCursor.store(consumerCursor, std::memory_order_release);
+                gpuEvent.set();
+
+                if (exit || !success)
+                    break;
+            }
+
+            report();
+        }
+
+        file->unmap(ring);
+    }
+    else
+    {
+        MemoryMappedFile file;
+        auto memoryMap = static_cast<uint8_t*>(file.map());
+        std::vector<uint8_t> messages(MemoryMappedFile::s_size);
+
+        while (success)
+        {
+            cpuEvent.wait();
+            cpuEvent.reset();
+
+            const uint32_t byteSize = *reinterpret_cast<const uint32_t*>(memoryMap);
+            memcpy(messages.data(), memoryMap, byteSize != 0 ? byteSize : sizeof(uint32_t));
+
+            gpuEvent.set();
+
+            if (byteSize <= sizeof(uint32_t))
+                break;
+
+            success = consumeBatch(messages.data(), byteSize, payloadHeap, stats);
+            report();
+        }
+
+        file.unmap(memoryMap);
+    }
+
+    if (payloadHeap != nullptr)
+        payloadHeapFile->unmap(payloadHeap);
+
+    printf("Consumed %llu batches, %llu messages, %.3f MB\n",
+        static_cast<unsigned long long>(stats.batchCount),
+        static_cast<unsigned long long>(stats.messageCount),
+        static_cast<double>(stats.byteSize) / (1024.0 * 1024.0));
+
+    return success ? 0 : 1;
+}
+
+static int produce(int argc, char* argv[])
+{
+    const uint32_t slotCount = std::clamp(getOption(argc, argv, "--ring", 0), 0u, MessageRingHeader::s_maxSlotCount);
+    const uint32_t commitThreadDepth = getOption(argc, argv, "--commit-thread", 0);
+    const uint32_t batchCount = getOption(argc, argv, "--batches", 1000);
+    const uint32_t batchSize = std::clamp(getOption(argc, argv, "--batch-size", 1024 * 1024), 0x100u, static_cast<uint32_t>(MemoryMappedFile::s_size));
+    const uint32_t messageSize = std::clamp(getOption(argc, argv, "--message-size", 0x100), 0u, batchSize / 2);
+
+    Configuration::s_zeroCopyTransport = slotCount != 0;
+    Configuration::s_messageRingSlotCount = slotCount;
+    Configuration::s_commitThreadDepth = commitThreadDepth;
+
+    s_messageSender.init();
+
+    // Lays out the messages by hand through the untyped interface, GCC and Clang
+    // ignore alignas on members of packed structs and would misplace the data.
+    const MessageInfo& info = s_messageInfos[MsgWriteVertexBuffer::s_id];
+    const uint32_t alignment = 0x10;
+
+    std::vector<double> latencies;
+    latencies.reserve(batchCount);
+
+    uint64_t totalSize = 0;
+    const auto begin = Clock::now();
+
+    for (uint32_t i = 0; i <= batchCount; i++)
+    {
+        // Follows the layout of MessageSender to stop at the batch size, the last
+        // batch is left empty to tell the consumer to exit
+        if (i < batchCount)
+        {
+            uint32_t offset = sizeof(uint32_t);
+            uint32_t index = 0;
+
+            while (true)
+            {
+                if ((offset & (alignment - 1)) != 0)
+                    offset = (offset + offsetof(MsgPadding, data) + alignment - 1) & ~(alignment - 1);
+
+                if (offset + info.headerSize + messageSize > batchSize)
+                    break;
+
+                auto message = static_cast<uint8_t*>(s_messageSender.makeMessage(info.headerSize + messageSize, alignment));
+                memset(message, 0, info.headerSize);
+                message[0] = MsgWriteVertexBuffer::s_id;
+                memcpy(message + offsetof(MsgWriteVertexBuffer, vertexBufferId), &index, sizeof(index));
+                memcpy(message + info.dataSizeOffset, &messageSize, sizeof(messageSize));
+                memset(message + info.headerSize, static_cast<int>(index), messageSize);
+                s_messageSender.endMessage();
+
+                offset += info.headerSize + messageSize;
+                ++index;
+            }
+        }
+
+        const auto commitBegin = Clock::now();
+
+        s_messageSender.commitMessages();
+
+        if (i < batchCount)
+        {
+            latencies.push_back(getMilliseconds(commitBegin, Clock::now()));
+            totalSize += s_messageSender.getLastCommittedSize();
+        }
+    }
+
+    const double seconds = getMilliseconds(begin, Clock::now()) / 1000.0;
+
+    if (latencies.empty())
+        return 0;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    double average = 0.0;
+    for (double latency : latencies)
+        average += latency;
+
+    average /= static_cast<double>(latencies.size());
+
+    printf("%u batches of %u bytes, %u byte messages, %s transport\n", batchCount, batchSize, messageSize,
+        slotCount != 0 ? "ring" : s_messageSender.isCommitPipelined() ? "pipelined copy" : "copy");
+
+    printf("Commit latency: min %.3f ms, avg %.3f ms, p99 %.3f ms, max %.3f ms\n",
+        latencies.front(), average, latencies[latencies.size() * 99 / 100], latencies.back());
+
+    printf("Throughput: %.1f batches/s, %.1f MB/s\n",
+        static_cast<double>(batchCount) / seconds,
+        static_cast<double>(totalSize) / (1024.0 * 1024.0 * seconds));
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc >= 2 && strcmp(argv[1], "consume") == 0)
+        return consume(argc, argv);
+
+    if (argc >= 2 && strcmp(argv[1], "produce") == 0)
+        return produce(argc, argv);
+
+    fprintf(stderr,
+        "Usage:\n"
+        "  %s consume [--ring] [--payload-heap]\n"
+        "  %s produce [--ring <slots>] [--commit-thread <depth>] [--batches <count>] [--batch-size <bytes>] [--message-size <bytes>]\n",
+        argv[0], argv[0]);
+
+    return 1;
+}
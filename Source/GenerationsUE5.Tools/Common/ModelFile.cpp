@@ -0,0 +1,253 @@
+#include "ModelFile.h"
+
+#include <MeshConversion.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+uint32_t read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return MeshConversion::byteSwap(value);
+}
+
+void write32(uint8_t* data, uint32_t value)
+{
+    value = MeshConversion::byteSwap(value);
+    memcpy(data, &value, sizeof(value));
+}
+
+bool ModelFile::load(const std::vector<uint8_t>& file, const char* path)
+{
+    if (file.size() < sizeof(SampleChunkHeaderV1))
+    {
+        fprintf(stderr, "%s: file is truncated\n", path);
+        return false;
+    }
+
+    const uint32_t fileSize = read32(file.data());
+    if (fileSize & SampleChunkHeaderV2::s_flag)
+    {
+        fprintf(stderr, "%s: already a SampleChunk V2 file, skipping\n", path);
+        return false;
+    }
+
+    const uint32_t version = read32(file.data() + offsetof(SampleChunkHeaderV1, version));
+    if (version != 5)
+    {
+        fprintf(stderr, "%s: unsupported version %u\n", path, version);
+        return false;
+    }
+
+    const uint32_t dataSize = read32(file.data() + offsetof(SampleChunkHeaderV1, dataSize));
+    const uint32_t data = read32(file.data() + offsetof(SampleChunkHeaderV1, data));
+    const uint32_t relocationTable = read32(file.data() + offsetof(SampleChunkHeaderV1, relocationTable));
+
+    if (fileSize > file.size() || data > fileSize || dataSize > fileSize - data ||
+        relocationTable > fileSize - sizeof(uint32_t))
+    {
+        fprintf(stderr, "%s: header is invalid\n", path);
+        return false;
+    }
+
+    const uint32_t relocationCount = read32(file.data() + relocationTable);
+    if (relocationCount > (fileSize - relocationTable - sizeof(uint32_t)) / sizeof(uint32_t))
+    {
+        fprintf(stderr, "%s: relocation table is truncated\n", path);
+        return false;
+    }
+
+    m_data.assign(file.begin() + data, file.begin() + data + dataSize);
+    m_relocations.resize(relocationCount);
+
+    for (uint32_t i = 0; i < relocationCount; i++)
+    {
+        m_relocations[i] = read32(file.data() + relocationTable + (i + 1) * sizeof(uint32_t));
+
+        if (!isValid(m_relocations[i], sizeof(uint32_t)))
+        {
+            fprintf(stderr, "%s: relocation %u is out of bounds\n", path, i);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t ModelFile::getSize() const
+{
+    return static_cast<uint32_t>(m_data.size());
+}
+
+bool ModelFile::isValid(uint32_t offset, uint32_t byteSize) const
+{
+    return offset <= m_data.size() && byteSize <= m_data.size() - offset;
+}
+
+uint32_t ModelFile::get(uint32_t offset) const
+{
+    return read32(m_data.data() + offset);
+}
+
+void ModelFile::set(uint32_t offset, uint32_t value)
+{
+    write32(m_data.data() + offset, value);
+}
+
+uint8_t* ModelFile::getData(uint32_t offset)
+{
+    return m_data.data() + offset;
+}
+
+uint32_t ModelFile::append(const void* data, uint32_t byteSize)
+{
+    m_data.resize((m_data.size() + 3) & ~3);
+
+    const uint32_t offset = static_cast<uint32_t>(m_data.size());
+    m_data.insert(m_data.end(), static_cast<const uint8_t*>(data), static_cast<const uint8_t*>(data) + byteSize);
+
+    return offset;
+}
+
+void ModelFile::setPointer(uint32_t offset, uint32_t value)
+{
+    set(offset, value);
+
+    // Null pointers aren't in the relocation table
+    if (std::find(m_relocations.begin(), m_relocations.end(), offset) == m_relocations.end())
+        m_relocations.push_back(offset);
+}
+
+void ModelFile::save(std::vector<uint8_t>& file, const std::vector<SampleChunkNode>& nodes, const std::vector<uint32_t>& nodeRelocations) const
+{
+    // V2 offsets are relative to the end of the header, which is where the nodes start
+    const uint32_t nodeSize = static_cast<uint32_t>(nodes.size() * sizeof(SampleChunkNode));
+    const uint32_t dataOffset = sizeof(SampleChunkHeaderV2) + nodeSize;
+    const uint32_t dataSize = static_cast<uint32_t>((m_data.size() + 3) & ~3);
+    const uint32_t relocationTable = dataOffset + dataSize;
+    const uint32_t offsetCount = static_cast<uint32_t>(nodeRelocations.size() + m_relocations.size());
+
+    file.assign(relocationTable + offsetCount * sizeof(uint32_t), 0);
+
+    auto header = file.data();
+    write32(header + offsetof(SampleChunkHeaderV2, fileSize), static_cast<uint32_t>(file.size()) | SampleChunkHeaderV2::s_flag);
+    write32(header + offsetof(SampleChunkHeaderV2, version), 5);
+    write32(header + offsetof(SampleChunkHeaderV2, relocationTable), relocationTable);
+    write32(header + offsetof(SampleChunkHeaderV2, offsetCount), offsetCount);
+
+    memcpy(file.data() + sizeof(SampleChunkHeaderV2), nodes.data(), nodeSize);
+    memcpy(file.data() + dataOffset, m_data.data(), m_data.size());
+
+    uint8_t* relocations = file.data() + relocationTable;
+
+    for (const uint32_t offset : nodeRelocations)
+    {
+        write32(relocations, offset);
+        relocations += sizeof(uint32_t);
+    }
+
+    for (const uint32_t offset : m_relocations)
+    {
+        uint8_t* pointer = file.data() + dataOffset + offset;
+        write32(pointer, read32(pointer) + nodeSize);
+
+        write32(relocations, offset + nodeSize);
+        relocations += sizeof(uint32_t);
+    }
+}
+
+bool readFile(const std::filesystem::path& path, std::vector<uint8_t>& data)
+{
+    FILE* file = fopen(path.string().c_str(), "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Unable to open %s\n", path.string().c_str());
+        return false;
+    }
+
+    data.resize(std::filesystem::file_size(path));
+    const bool read = fread(data.data(), 1, data.size(), file) == data.size();
+    fclose(file);
+
+    if (!read)
+        fprintf(stderr, "Unable to read %s\n", path.string().c_str());
+
+    return read;
+}
+
+bool isModelFile(const std::filesystem::path& path)
+{
+    return path.extension() == ".model" || path.extension() == ".terrain-model";
+}
+
+static bool collectMeshArray(const ModelFile& file, uint32_t count, uint32_t meshes, std::vector<uint32_t>& result)
+{
+    if (!file.isValid(meshes, count * sizeof(uint32_t)))
+        return false;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t mesh = file.get(meshes + i * sizeof(uint32_t));
+        if (!file.isValid(mesh, MeshOffsets::s_size))
+            return false;
+
+        result.push_back(mesh);
+    }
+
+    return true;
+}
+
+// Mesh groups have opaque, transparent and punch through meshes followed by
+// named special groups, which is the same for models and terrain models
+bool collectMeshes(const ModelFile& file, std::vector<uint32_t>& meshes)
+{
+    if (!file.isValid(0, 8))
+        return false;
+
+    const uint32_t meshGroupCount = file.get(0);
+    const uint32_t meshGroups = file.get(4);
+
+    if (!file.isValid(meshGroups, meshGroupCount * sizeof(uint32_t)))
+        return false;
+
+    for (uint32_t i = 0; i < meshGroupCount; i++)
+    {
+        const uint32_t meshGroup = file.get(meshGroups + i * sizeof(uint32_t));
+        if (!file.isValid(meshGroup, 0x28))
+            return false;
+
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            if (!collectMeshArray(file, file.get(meshGroup + j * 8), file.get(meshGroup + j * 8 + 4), meshes))
+                return false;
+        }
+
+        const uint32_t specialGroupCount = file.get(meshGroup + 0x18);
+        const uint32_t specialGroupCounts = file.get(meshGroup + 0x20);
+        const uint32_t specialGroupMeshes = file.get(meshGroup + 0x24);
+
+        if (!file.isValid(specialGroupCounts, specialGroupCount * sizeof(uint32_t)) ||
+            !file.isValid(specialGroupMeshes, specialGroupCount * sizeof(uint32_t)))
+        {
+            return false;
+        }
+
+        for (uint32_t j = 0; j < specialGroupCount; j++)
+        {
+            const uint32_t count = file.get(specialGroupCounts + j * sizeof(uint32_t));
+            if (!file.isValid(count, sizeof(uint32_t)))
+                return false;
+
+            if (!collectMeshArray(file, file.get(count), file.get(specialGroupMeshes + j * sizeof(uint32_t)), meshes))
+                return false;
+        }
+    }
+
+    // Meshes can be shared between groups, they must be converted only once
+    std::sort(meshes.begin(), meshes.end());
+    meshes.erase(std::unique(meshes.begin(), meshes.end()), meshes.end());
+
+    return true;
+}
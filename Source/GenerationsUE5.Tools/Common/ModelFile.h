@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SampleChunk.h>
+
+#include <filesystem>
+#include <vector>
+
+// SampleChunk V1 model files, shared between the model tools
+
+uint32_t read32(const uint8_t* data);
+void write32(uint8_t* data, uint32_t value);
+
+// Data of a V1 file, pointers and relocations are offsets from the start of it
+class ModelFile
+{
+protected:
+    std::vector<uint8_t> m_data;
+    std::vector<uint32_t> m_relocations;
+
+public:
+    bool load(const std::vector<uint8_t>& file, const char* path);
+
+    uint32_t getSize() const;
+    bool isValid(uint32_t offset, uint32_t byteSize) const;
+
+    uint32_t get(uint32_t offset) const;
+    void set(uint32_t offset, uint32_t value);
+    void setPointer(uint32_t offset, uint32_t value);
+    uint8_t* getData(uint32_t offset);
+
+    // Appends 4 byte aligned data and returns its offset
+    uint32_t append(const void* data, uint32_t byteSize);
+
+    void save(std::vector<uint8_t>& file, const std::vector<SampleChunkNode>& nodes, const std::vector<uint32_t>& nodeRelocations) const;
+};
+
+struct MeshOffsets
+{
+    static constexpr uint32_t s_materialName = 0x0;
+    static constexpr uint32_t s_indexCount = 0x4;
+    static constexpr uint32_t s_indices = 0x8;
+    static constexpr uint32_t s_vertexCount = 0xC;
+    static constexpr uint32_t s_vertexSize = 0x10;
+    static constexpr uint32_t s_vertexData = 0x14;
+    static constexpr uint32_t s_vertexElements = 0x18;
+    static constexpr uint32_t s_nodeCount = 0x1C;
+    static constexpr uint32_t s_size = 0x20;
+};
+
+bool readFile(const std::filesystem::path& path, std::vector<uint8_t>& data);
+bool isModelFile(const std::filesystem::path& path);
+
+// Offsets of the meshes in every mesh group, without duplicates
+bool collectMeshes(const ModelFile& file, std::vector<uint32_t>& meshes);
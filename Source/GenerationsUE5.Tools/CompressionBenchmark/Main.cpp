@@ -0,0 +1,178 @@
+#include <Message.h>
+#include <MessageInfo.h>
+#include <MessageTrace.h>
+
+#include <lz4.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Runs the bulk payloads of a .gensrt capture through the LZ4 compression used by
+// the CompressTextures/CompressVertexBuffers/CompressIndexBuffers options, and
+// reports the compression ratio and throughput per payload type.
+// Usage: CompressionBenchmark <trace.gensrt> [threshold]
+
+struct PayloadStats
+{
+    const char* name;
+    uint64_t count;
+    uint64_t compressedCount;
+    uint64_t uncompressedSize;
+    uint64_t compressedSize;
+    double encodeSeconds;
+    double decodeSeconds;
+};
+
+using Clock = std::chrono::steady_clock;
+
+static double getSeconds(Clock::time_point begin, Clock::time_point end)
+{
+    return std::chrono::duration<double>(end - begin).count();
+}
+
+static void benchmarkPayload(const uint8_t* data, uint32_t byteSize, PayloadStats& stats,
+    std::vector<char>& compressed, std::vector<char>& decompressed)
+{
+    // Same cut off as MessageCompression, anything saving less than 1/8 is sent as is
+    const uint32_t maxCompressedSize = byteSize - byteSize / 8;
+    compressed.resize(maxCompressedSize);
+    decompressed.resize(byteSize);
+
+    const auto encodeBegin = Clock::now();
+    const int compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(data),
+        compressed.data(), static_cast<int>(byteSize), static_cast<int>(maxCompressedSize));
+    stats.encodeSeconds += getSeconds(encodeBegin, Clock::now());
+
+    ++stats.count;
+    stats.uncompressedSize += byteSize;
+
+    if (compressedSize <= 0)
+    {
+        stats.compressedSize += byteSize;
+        return;
+    }
+
+    const auto decodeBegin = Clock::now();
+    const int decompressedSize = LZ4_decompress_safe(compressed.data(), decompressed.data(),
+        compressedSize, static_cast<int>(byteSize));
+    stats.decodeSeconds += getSeconds(decodeBegin, Clock::now());
+
+    if (decompressedSize != static_cast<int>(byteSize) || memcmp(decompressed.data(), data, byteSize) != 0)
+        fprintf(stderr, "%s: round trip mismatch\n", stats.name);
+
+    ++stats.compressedCount;
+    stats.compressedSize += compressedSize;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace.gensrt> [threshold]\n", argv[0]);
+        return 1;
+    }
+
+    const uint32_t threshold = argc > 2 ? strtoul(argv[2], nullptr, 0) : 0x10000;
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Unable to open %s\n", argv[1]);
+        return 1;
+    }
+
+    MessageTraceHeader header{};
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MessageTraceHeader::s_magic ||
+        header.version != MessageTraceHeader::s_version)
+    {
+        fprintf(stderr, "%s is not a supported message trace\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    PayloadStats textureStats{ "Textures" };
+    PayloadStats vertexBufferStats{ "Vertex buffers" };
+    PayloadStats indexBufferStats{ "Index buffers" };
+
+    std::vector<uint8_t> data;
+    std::vector<char> compressed;
+    std::vector<char> decompressed;
+
+    MessageTraceFrame frame{};
+    while (fread(&frame, sizeof(frame), 1, file) == 1)
+    {
+        data.resize(frame.byteSize);
+        if (fread(data.data(), 1, frame.byteSize, file) != frame.byteSize)
+        {
+            fprintf(stderr, "Frame %u is truncated\n", frame.frameIndex);
+            break;
+        }
+
+        uint32_t offset = sizeof(uint32_t);
+        while (offset < frame.byteSize)
+        {
+            const MessageInfo* info = MessageInfo::get(data[offset]);
+            if (info == nullptr)
+            {
+                fprintf(stderr, "Frame %u: unknown message id %u\n", frame.frameIndex, data[offset]);
+                break;
+            }
+
+            uint32_t headerSize = info->headerSize;
+            uint32_t byteSize = info->getByteSize(data.data() + offset);
+
+            // Debug builds store the texture name in front of the data size
+            if (header.debugLayout != 0 && info->id == MsgMakeTexture::s_id)
+            {
+                MessageInfo debugInfo = *info;
+                debugInfo.headerSize += 0x100;
+                debugInfo.dataSizeOffset += 0x100;
+                headerSize = debugInfo.headerSize;
+                byteSize = debugInfo.getByteSize(data.data() + offset);
+            }
+
+            if (offset + byteSize > frame.byteSize)
+            {
+                fprintf(stderr, "Frame %u: %s overruns the frame\n", frame.frameIndex, info->name);
+                break;
+            }
+
+            PayloadStats* stats = nullptr;
+            if (info->id == MsgMakeTexture::s_id)
+                stats = &textureStats;
+            else if (info->id == MsgWriteVertexBuffer::s_id)
+                stats = &vertexBufferStats;
+            else if (info->id == MsgWriteIndexBuffer::s_id)
+                stats = &indexBufferStats;
+
+            const uint32_t payloadSize = byteSize - headerSize;
+            if (stats != nullptr && payloadSize >= threshold)
+                benchmarkPayload(data.data() + offset + headerSize, payloadSize, *stats, compressed, decompressed);
+
+            offset += byteSize;
+        }
+    }
+
+    fclose(file);
+
+    printf("%-16s %8s %10s %12s %12s %8s %12s %12s\n",
+        "Payload", "Count", "Compressed", "Input MB", "Output MB", "Ratio", "Encode MB/s", "Decode MB/s");
+
+    for (const PayloadStats* stats : { &textureStats, &vertexBufferStats, &indexBufferStats })
+    {
+        const double inputMb = static_cast<double>(stats->uncompressedSize) / (1024.0 * 1024.0);
+        const double outputMb = static_cast<double>(stats->compressedSize) / (1024.0 * 1024.0);
+
+        printf("%-16s %8llu %10llu %12.3f %12.3f %8.3f %12.1f %12.1f\n", stats->name,
+            static_cast<unsigned long long>(stats->count),
+            static_cast<unsigned long long>(stats->compressedCount),
+            inputMb, outputMb,
+            outputMb > 0.0 ? inputMb / outputMb : 0.0,
+            stats->encodeSeconds > 0.0 ? inputMb / stats->encodeSeconds : 0.0,
+            stats->decodeSeconds > 0.0 ? inputMb / stats->decodeSeconds : 0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <MeshConversion.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Converts the same synthetic models on one thread and then on many threads at once,
+// the way loader threads convert models in the game, and checks that every model
+// comes out byte for byte the same. Scratch state is thread local like in MeshData,
+// indices accumulate over the meshes of a model before getting flushed.
+// Usage: ConversionStressTest [thread count] [model count] [rounds] [seed]
+
+static constexpr uint32_t s_maxVertexElementCount = 32;
+static constexpr uint32_t s_vertexSize = 88;
+
+struct Mesh
+{
+    std::vector<uint8_t> vertices;
+    std::vector<uint16_t> indices;
+    uint32_t vertexCount;
+    uint32_t nodeCount;
+};
+
+struct Model
+{
+    std::vector<Mesh> meshes;
+    bool terrain;
+};
+
+struct ConvertedModel
+{
+    std::vector<uint8_t> vertices;
+    std::vector<VertexElement> elements;
+    std::vector<uint32_t> vertexSizes;
+    std::vector<uint16_t> triangles;
+    std::vector<uint32_t> adjacency;
+
+    bool operator==(const ConvertedModel& other) const
+    {
+        return vertices == other.vertices && vertexSizes == other.vertexSizes && triangles == other.triangles &&
+            adjacency == other.adjacency && elements.size() == other.elements.size() &&
+            memcmp(elements.data(), other.elements.data(), elements.size() * sizeof(VertexElement)) == 0;
+    }
+};
+
+static VertexElement makeElement(uint16_t offset, uint32_t type, uint8_t usage, uint8_t usageIndex)
+{
+    // Mesh resources are big-endian
+    return { 0, MeshConversion::byteSwap(offset), MeshConversion::byteSwap(type), 0, usage, usageIndex };
+}
+
+static const VertexElement s_vertexElements[] =
+{
+    makeElement(0, DECLTYPE_FLOAT3, DECLUSAGE_POSITION, 0),
+    makeElement(12, DECLTYPE_FLOAT3, DECLUSAGE_NORMAL, 0),
+    makeElement(24, DECLTYPE_FLOAT3, DECLUSAGE_TANGENT, 0),
+    makeElement(36, DECLTYPE_FLOAT3, DECLUSAGE_BINORMAL, 0),
+    makeElement(48, DECLTYPE_FLOAT2, DECLUSAGE_TEXCOORD, 0),
+    makeElement(56, DECLTYPE_FLOAT2, DECLUSAGE_TEXCOORD, 1),
+    makeElement(64, DECLTYPE_FLOAT4, DECLUSAGE_COLOR, 0),
+    makeElement(80, DECLTYPE_UBYTE4, DECLUSAGE_BLENDINDICES, 0),
+    makeElement(84, DECLTYPE_UBYTE4N, DECLUSAGE_BLENDWEIGHT, 0),
+    { MeshConversion::byteSwap(static_cast<uint16_t>(0xFF)), 0, DECLTYPE_UNUSED, 0, 0, 0 },
+};
+
+static void storeFloat(uint8_t* destination, float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits = MeshConversion::byteSwap(bits);
+    memcpy(destination, &bits, sizeof(bits));
+}
+
+static Model makeModel(std::mt19937& random)
+{
+    Model model;
+    model.terrain = random() % 4 == 0;
+
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    const uint32_t meshCount = 1 + random() % 6;
+
+    for (uint32_t i = 0; i < meshCount; i++)
+    {
+        Mesh mesh;
+        mesh.vertexCount = 3 + random() % 3000;
+        mesh.nodeCount = random() % 2 == 0 ? 0 : 1 + random() % 64;
+        mesh.vertices.resize(mesh.vertexCount * s_vertexSize);
+
+        for (uint32_t j = 0; j < mesh.vertexCount; j++)
+        {
+            uint8_t* vertex = &mesh.vertices[j * s_vertexSize];
+
+            for (uint32_t k = 0; k < 80; k += 4)
+                storeFloat(vertex + k, distribution(random) * (k < 12 ? 100.0f : 1.0f));
+
+            for (uint32_t k = 80; k < s_vertexSize; k++)
+                vertex[k] = static_cast<uint8_t>(random());
+        }
+
+        // Triangle strips with restart indices and the odd degenerate triangle
+        const uint32_t indexCount = random() % (mesh.vertexCount * 4);
+        for (uint32_t j = 0; j < indexCount; j++)
+        {
+            const uint16_t index = random() % 32 == 0 ? 0xFFFF : static_cast<uint16_t>(random() % mesh.vertexCount);
+            mesh.indices.push_back(MeshConversion::byteSwap(index));
+        }
+
+        model.meshes.push_back(std::move(mesh));
+    }
+
+    return model;
+}
+
+static thread_local std::vector<uint8_t> s_scratch;
+static thread_local std::vector<uint16_t> s_triangles;
+
+static ConvertedModel convertModel(const Model& model)
+{
+    ConvertedModel converted;
+
+    for (const auto& mesh : model.meshes)
+    {
+        std::vector<uint8_t> vertices = mesh.vertices;
+        VertexElement elements[s_maxVertexElementCount]{};
+        memcpy(elements, s_vertexElements, sizeof(s_vertexElements));
+
+        const uint32_t vertexSize = MeshConversion::optimizeVertexFormat(vertices.data(), mesh.vertexCount, s_vertexSize,
+            elements, mesh.nodeCount, model.terrain, s_scratch, MeshConversion::convertScalar, MeshConversion::byteSwap32Scalar);
+
+        converted.vertexSizes.push_back(vertexSize);
+        converted.vertices.insert(converted.vertices.end(), vertices.begin(), vertices.begin() + mesh.vertexCount * vertexSize);
+
+        for (const auto& element : elements)
+        {
+            converted.elements.push_back(element);
+
+            if (MeshConversion::byteSwap(element.stream) == 0xFF || element.type == DECLTYPE_UNUSED)
+                break;
+        }
+
+        const size_t triangleOffset = s_triangles.size();
+        MeshConversion::convertToTriangles(mesh.indices.data(), static_cast<uint32_t>(mesh.indices.size()), s_triangles);
+
+        const uint32_t indexCount = static_cast<uint32_t>(s_triangles.size() - triangleOffset);
+        const size_t adjacencyOffset = converted.adjacency.size();
+        converted.adjacency.resize(adjacencyOffset + MeshConversion::getAdjacencySize(mesh.vertexCount, indexCount));
+
+        MeshConversion::generateAdjacency(mesh.vertexCount, indexCount,
+            [&](uint32_t i) { return s_triangles[triangleOffset + i]; }, converted.adjacency.data() + adjacencyOffset);
+    }
+
+    // Flushed once per model, the way ProcessShareVertexBuffer does it
+    converted.triangles = s_triangles;
+    s_triangles.clear();
+
+    return converted;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t threadCount = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) :
+        std::max(std::thread::hardware_concurrency(), 4u);
+
+    const uint32_t modelCount = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 200;
+    const uint32_t roundCount = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 5;
+    const uint32_t seed = argc > 4 ? static_cast<uint32_t>(strtoul(argv[4], nullptr, 10)) : 0;
+
+    if (threadCount == 0)
+    {
+        printf("Thread count needs to be non-zero\n");
+        return 1;
+    }
+
+    std::mt19937 random(seed);
+
+    std::vector<Model> models;
+    for (uint32_t i = 0; i < modelCount; i++)
+        models.push_back(makeModel(random));
+
+    std::vector<ConvertedModel> expected;
+    for (const auto& model : models)
+        expected.push_back(convertModel(model));
+
+    uint32_t mismatchCount = 0;
+
+    for (uint32_t round = 0; round < roundCount; round++)
+    {
+        // Every round hands the models out in a different order
+        std::vector<uint32_t> order(modelCount);
+        for (uint32_t i = 0; i < modelCount; i++)
+            order[i] = i;
+
+        std::shuffle(order.begin(), order.end(), random);
+
+        std::vector<ConvertedModel> results(modelCount);
+        std::atomic<uint32_t> next = 0;
+        std::vector<std::thread> threads;
+
+        for (uint32_t i = 0; i < threadCount; i++)
+        {
+            threads.emplace_back([&]
+            {
+                uint32_t index;
+                while ((index = next.fetch_add(1)) < modelCount)
+                    results[order[index]] = convertModel(models[order[index]]);
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (uint32_t i = 0; i < modelCount; i++)
+        {
+            if (!(results[i] == expected[i]))
+            {
+                if (mismatchCount < 10)
+                    printf("Model %u differs from the single threaded conversion in round %u\n", i, round);
+
+                ++mismatchCount;
+            }
+        }
+    }
+
+    printf("%u models on %u threads over %u rounds: %s\n", modelCount, threadCount, roundCount, mismatchCount == 0 ? "OK" : "MISMATCH");
+    return mismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,281 @@
+#include "ModelFile.h"
+
+#include <MeshConversion.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Reports how the ReorderTriangles option affects the meshes of SampleChunk V1 models.
+// ACMR is the average cache miss ratio of a FIFO vertex cache, lower is better.
+// SAH is the surface area heuristic cost of a hierarchy that splits the triangle list in
+// halves, so it measures how spatially coherent the triangle order is. Lower is better.
+// Usage: MeshMetrics <input file or directory>...
+
+static constexpr uint32_t s_fifoCacheSize = 32;
+static constexpr uint32_t s_leafTriangleCount = 4;
+
+struct Bounds
+{
+    float min[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float max[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    void add(const float* position)
+    {
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            min[i] = std::min(min[i], position[i]);
+            max[i] = std::max(max[i], position[i]);
+        }
+    }
+
+    void add(const Bounds& bounds)
+    {
+        add(bounds.min);
+        add(bounds.max);
+    }
+
+    float getArea() const
+    {
+        if (min[0] > max[0])
+            return 0.0f;
+
+        const float x = max[0] - min[0];
+        const float y = max[1] - min[1];
+        const float z = max[2] - min[2];
+        return 2.0f * (x * y + y * z + z * x);
+    }
+};
+
+struct Metrics
+{
+    uint64_t triangleCount = 0;
+    uint64_t cacheMissCount = 0;
+    double weightedSah = 0.0;
+
+    void add(const Metrics& metrics)
+    {
+        triangleCount += metrics.triangleCount;
+        cacheMissCount += metrics.cacheMissCount;
+        weightedSah += metrics.weightedSah;
+    }
+
+    double getAcmr() const
+    {
+        return triangleCount != 0 ? static_cast<double>(cacheMissCount) / static_cast<double>(triangleCount) : 0.0;
+    }
+
+    double getSah() const
+    {
+        return triangleCount != 0 ? weightedSah / static_cast<double>(triangleCount) : 0.0;
+    }
+};
+
+static uint64_t getCacheMissCount(const std::vector<uint16_t>& indices, uint32_t vertexCount)
+{
+    // Timestamps of when vertices entered the cache
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = s_fifoCacheSize + 1;
+    uint64_t missCount = 0;
+
+    for (const uint16_t index : indices)
+    {
+        if (time - timestamps[index] > s_fifoCacheSize)
+        {
+            timestamps[index] = time;
+            ++time;
+            ++missCount;
+        }
+    }
+
+    return missCount;
+}
+
+static Bounds getSahCost(const std::vector<uint16_t>& indices, const std::vector<float>& positions,
+    uint32_t begin, uint32_t end, double& cost)
+{
+    Bounds bounds;
+
+    if (end - begin <= s_leafTriangleCount)
+    {
+        for (uint32_t i = begin * 3; i < end * 3; i++)
+            bounds.add(&positions[indices[i] * 3]);
+
+        cost += bounds.getArea() * (end - begin);
+    }
+    else
+    {
+        const uint32_t middle = begin + (end - begin) / 2;
+        bounds.add(getSahCost(indices, positions, begin, middle, cost));
+        bounds.add(getSahCost(indices, positions, middle, end, cost));
+
+        cost += bounds.getArea();
+    }
+
+    return bounds;
+}
+
+static Metrics getMetrics(const std::vector<uint16_t>& indices, const std::vector<float>& positions, uint32_t vertexCount)
+{
+    Metrics metrics;
+    metrics.triangleCount = indices.size() / 3;
+    metrics.cacheMissCount = getCacheMissCount(indices, vertexCount);
+
+    if (metrics.triangleCount != 0)
+    {
+        double cost = 0.0;
+        const Bounds bounds = getSahCost(indices, positions, 0, static_cast<uint32_t>(metrics.triangleCount), cost);
+
+        // Normalized to the root so that meshes of different sizes can be weighted by their triangle count
+        if (bounds.getArea() > 0.0f)
+            metrics.weightedSah = cost / bounds.getArea() * metrics.triangleCount;
+    }
+
+    return metrics;
+}
+
+static bool measureMesh(ModelFile& file, uint32_t mesh, std::vector<uint16_t>& triangles, std::vector<float>& positions,
+    TriangleReorderScratch& scratch, Metrics& before, Metrics& after)
+{
+    const uint32_t vertexCount = file.get(mesh + MeshOffsets::s_vertexCount);
+    const uint32_t vertexSize = file.get(mesh + MeshOffsets::s_vertexSize);
+    const uint32_t vertexData = file.get(mesh + MeshOffsets::s_vertexData);
+    const uint32_t vertexElements = file.get(mesh + MeshOffsets::s_vertexElements);
+    const uint32_t indexCount = file.get(mesh + MeshOffsets::s_indexCount);
+    const uint32_t indices = file.get(mesh + MeshOffsets::s_indices);
+
+    if (!file.isValid(vertexData, vertexCount * vertexSize) ||
+        !file.isValid(indices, indexCount * sizeof(uint16_t)) ||
+        !file.isValid(vertexElements, sizeof(VertexElement)))
+    {
+        return false;
+    }
+
+    // Position always comes first in the vertex elements
+    VertexElement element;
+    memcpy(&element, file.getData(vertexElements), sizeof(VertexElement));
+
+    const uint32_t positionOffset = MeshConversion::byteSwap(element.offset);
+
+    if (element.usage != DECLUSAGE_POSITION || MeshConversion::byteSwap(element.type) != DECLTYPE_FLOAT3 ||
+        positionOffset + 12 > vertexSize)
+    {
+        return false;
+    }
+
+    positions.resize(vertexCount * 3);
+
+    for (uint32_t i = 0; i < vertexCount; i++)
+    {
+        MeshConversion::byteSwap32Scalar(reinterpret_cast<uint8_t*>(&positions[i * 3]),
+            file.getData(vertexData + i * vertexSize + positionOffset), 12);
+    }
+
+    triangles.clear();
+    MeshConversion::convertToTriangles(reinterpret_cast<const uint16_t*>(file.getData(indices)), indexCount, triangles);
+
+    for (const uint16_t index : triangles)
+    {
+        if (index >= vertexCount)
+            return false;
+    }
+
+    before = getMetrics(triangles, positions, vertexCount);
+
+    MeshConversion::reorderTriangles(triangles.data(), static_cast<uint32_t>(triangles.size()),
+        file.getData(vertexData + positionOffset), vertexSize, vertexCount, scratch);
+
+    after = getMetrics(triangles, positions, vertexCount);
+
+    return true;
+}
+
+static void printMetrics(const char* name, const Metrics& before, const Metrics& after)
+{
+    printf("%-40s %10llu %8.3f %8.3f %10.2f %10.2f\n", name, static_cast<unsigned long long>(before.triangleCount),
+        before.getAcmr(), after.getAcmr(), before.getSah(), after.getSah());
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <input file or directory>...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<std::filesystem::path> files;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::filesystem::is_directory(argv[i]))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(argv[i]))
+            {
+                if (entry.is_regular_file() && isModelFile(entry.path()))
+                    files.push_back(entry.path());
+            }
+        }
+        else
+        {
+            files.emplace_back(argv[i]);
+        }
+    }
+
+    printf("%-40s %10s %8s %8s %10s %10s\n", "File", "Triangles", "ACMR", "Reorder", "SAH", "Reorder");
+
+    std::vector<uint8_t> data;
+    std::vector<uint32_t> meshes;
+    std::vector<uint16_t> triangles;
+    std::vector<float> positions;
+    TriangleReorderScratch scratch;
+
+    Metrics totalBefore;
+    Metrics totalAfter;
+
+    for (const auto& path : files)
+    {
+        ModelFile file;
+        meshes.clear();
+
+        if (!readFile(path, data) || !file.load(data, path.string().c_str()))
+            continue;
+
+        if (!collectMeshes(file, meshes))
+        {
+            fprintf(stderr, "%s: mesh groups are invalid\n", path.string().c_str());
+            continue;
+        }
+
+        Metrics fileBefore;
+        Metrics fileAfter;
+
+        for (const uint32_t mesh : meshes)
+        {
+            Metrics before;
+            Metrics after;
+
+            if (measureMesh(file, mesh, triangles, positions, scratch, before, after))
+            {
+                fileBefore.add(before);
+                fileAfter.add(after);
+            }
+            else
+            {
+                fprintf(stderr, "%s: mesh at 0x%X can't be measured\n", path.string().c_str(), mesh);
+            }
+        }
+
+        printMetrics(path.filename().string().c_str(), fileBefore, fileAfter);
+
+        totalBefore.add(fileBefore);
+        totalAfter.add(fileAfter);
+    }
+
+    if (files.size() > 1)
+        printMetrics("Total", totalBefore, totalAfter);
+
+    return 0;
+}
@@ -0,0 +1,319 @@
+#include "ModelFile.h"
+
+#include <MeshConversion.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Converts SampleChunk V1 models and terrain models to SampleChunk V2 files that already
+// have the optimized vertex format, triangle list indices and the adjacency of smooth
+// normal meshes, so that the mod can skip all of it at load time.
+// Vertices can optionally be welded and triangles reordered the same way the WeldVertices
+// and ReorderTriangles options do it.
+// Usage: ModelConverter <input file or directory>... [--output <directory>] [--weld] [--reorder]
+
+static constexpr uint32_t s_maxVertexElementCount = 32;
+
+static bool convertMesh(ModelFile& file, uint32_t mesh, bool terrain, bool weld, bool reorder, std::vector<uint8_t>& scratch,
+    VertexWeldScratch& weldScratch, TriangleReorderScratch& reorderScratch, std::vector<uint16_t>& triangles,
+    std::vector<uint32_t>& adjacency, std::vector<SampleChunkAdjacency>& adjacencies, uint32_t& weldedVertexCount)
+{
+    uint32_t vertexCount = file.get(mesh + MeshOffsets::s_vertexCount);
+    const uint32_t vertexSize = file.get(mesh + MeshOffsets::s_vertexSize);
+    const uint32_t vertexData = file.get(mesh + MeshOffsets::s_vertexData);
+    const uint32_t vertexElements = file.get(mesh + MeshOffsets::s_vertexElements);
+    const uint32_t indexCount = file.get(mesh + MeshOffsets::s_indexCount);
+    const uint32_t indices = file.get(mesh + MeshOffsets::s_indices);
+
+    if (!file.isValid(vertexData, vertexCount * vertexSize) ||
+        !file.isValid(indices, indexCount * sizeof(uint16_t)))
+    {
+        return false;
+    }
+
+    // The elements get converted in a copy, the new declaration might be longer than the old one
+    VertexElement elements[s_maxVertexElementCount + 1];
+    uint32_t elementCount = 0;
+
+    while (true)
+    {
+        if (elementCount == s_maxVertexElementCount || !file.isValid(vertexElements + elementCount * sizeof(VertexElement), sizeof(VertexElement)))
+            return false;
+
+        auto& element = elements[elementCount];
+        memcpy(&element, file.getData(vertexElements + elementCount * sizeof(VertexElement)), sizeof(VertexElement));
+        ++elementCount;
+
+        if (MeshConversion::byteSwap(element.stream) == 0xFF || element.type == DECLTYPE_UNUSED)
+            break;
+
+        if (element.usage >= 14 || element.usageIndex >= 4)
+            return false;
+    }
+
+    const uint32_t newVertexSize = MeshConversion::optimizeVertexFormat(
+        file.getData(vertexData),
+        vertexCount,
+        vertexSize,
+        elements,
+        file.get(mesh + MeshOffsets::s_nodeCount),
+        terrain,
+        scratch,
+        MeshConversion::convertScalar,
+        MeshConversion::byteSwap32Scalar);
+
+    if (newVertexSize == 0)
+        return false;
+
+    file.set(mesh + MeshOffsets::s_vertexSize, newVertexSize);
+
+    uint32_t newElementCount = 0;
+    while (MeshConversion::byteSwap(elements[newElementCount].stream) != 0xFF && elements[newElementCount].type != DECLTYPE_UNUSED)
+        ++newElementCount;
+
+    ++newElementCount;
+
+    if (newElementCount <= elementCount)
+        memcpy(file.getData(vertexElements), elements, newElementCount * sizeof(VertexElement));
+    else
+        file.setPointer(mesh + MeshOffsets::s_vertexElements, file.append(elements, newElementCount * sizeof(VertexElement)));
+
+    if (weld)
+    {
+        // Welding remaps indices through a table, which needs them to be in range
+        const uint16_t* sourceIndices = reinterpret_cast<const uint16_t*>(file.getData(indices));
+        for (uint32_t i = 0; i < indexCount; i++)
+        {
+            const uint16_t index = MeshConversion::byteSwap(sourceIndices[i]);
+            if (index != 0xFFFF && index >= vertexCount)
+                return false;
+        }
+
+        const uint32_t newVertexCount = MeshConversion::weldVertices(file.getData(vertexData), vertexCount, newVertexSize,
+            reinterpret_cast<uint16_t*>(file.getData(indices)), indexCount, weldScratch);
+
+        weldedVertexCount += vertexCount - newVertexCount;
+        vertexCount = newVertexCount;
+
+        file.set(mesh + MeshOffsets::s_vertexCount, vertexCount);
+    }
+
+    triangles.clear();
+    MeshConversion::convertToTriangles(reinterpret_cast<const uint16_t*>(file.getData(indices)), indexCount, triangles);
+
+    const uint32_t triangleCount = static_cast<uint32_t>(triangles.size());
+
+    for (const uint16_t index : triangles)
+    {
+        if (index >= vertexCount)
+            return false;
+    }
+
+    if (reorder)
+        MeshConversion::reorderTriangles(triangles.data(), triangleCount, file.getData(vertexData), newVertexSize, vertexCount, reorderScratch);
+
+    const uint32_t materialName = file.get(mesh + MeshOffsets::s_materialName);
+    if (!file.isValid(materialName, 0))
+        return false;
+
+    const std::string name(reinterpret_cast<const char*>(file.getData(materialName)),
+        strnlen(reinterpret_cast<const char*>(file.getData(materialName)), file.getSize() - materialName));
+
+    // Adjacency is built from the little-endian indices before they get swapped back
+    if (name.find("_smooth_normal") != std::string::npos)
+    {
+        adjacency.resize(MeshConversion::getAdjacencySize(vertexCount, triangleCount));
+        MeshConversion::generateAdjacency(vertexCount, triangleCount,
+            [&](uint32_t i) { return triangles[i]; }, adjacency.data());
+
+        SampleChunkAdjacency entry;
+        entry.mesh = mesh;
+        entry.data = file.append(adjacency.data(), static_cast<uint32_t>(adjacency.size() * sizeof(uint32_t)));
+        entry.byteSize = static_cast<uint32_t>(adjacency.size() * sizeof(uint32_t));
+        adjacencies.push_back(entry);
+    }
+
+    for (auto& index : triangles)
+        index = MeshConversion::byteSwap(index);
+
+    file.set(mesh + MeshOffsets::s_indexCount, triangleCount);
+    file.setPointer(mesh + MeshOffsets::s_indices, file.append(triangles.data(), triangleCount * sizeof(uint16_t)));
+
+    return true;
+}
+
+static bool convertFile(const std::filesystem::path& inputPath, const std::filesystem::path& outputPath, bool weld, bool reorder)
+{
+    const std::string path = inputPath.string();
+    const bool terrain = inputPath.extension() == ".terrain-model";
+
+    std::vector<uint8_t> input;
+    if (!readFile(inputPath, input))
+        return false;
+
+    ModelFile file;
+    if (!file.load(input, path.c_str()))
+        return false;
+
+    std::vector<uint32_t> meshes;
+    if (!collectMeshes(file, meshes))
+    {
+        fprintf(stderr, "%s: mesh groups are invalid\n", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> scratch;
+    VertexWeldScratch weldScratch;
+    TriangleReorderScratch reorderScratch;
+    std::vector<uint16_t> triangles;
+    std::vector<uint32_t> adjacency;
+    std::vector<SampleChunkAdjacency> adjacencies;
+    uint32_t weldedVertexCount = 0;
+
+    for (const uint32_t mesh : meshes)
+    {
+        if (!convertMesh(file, mesh, terrain, weld, reorder, scratch, weldScratch, reorderScratch, triangles, adjacency, adjacencies, weldedVertexCount))
+        {
+            fprintf(stderr, "%s: mesh at 0x%X can't be converted\n", path.c_str(), mesh);
+            return false;
+        }
+    }
+
+    std::vector<SampleChunkNode> nodes;
+    std::vector<uint32_t> nodeRelocations;
+
+    auto addNode = [&](const char(&name)[8], uint32_t value)
+    {
+        SampleChunkNode node;
+        write32(reinterpret_cast<uint8_t*>(&node.flagsAndSize), sizeof(SampleChunkNode));
+        write32(reinterpret_cast<uint8_t*>(&node.value), value);
+        memcpy(node.name, name, sizeof(node.name));
+        nodes.push_back(node);
+    };
+
+    // Pointers are relative to the end of the header, where the nodes are
+    const uint32_t nodeSize = static_cast<uint32_t>((adjacencies.empty() ? 3 : 4) * sizeof(SampleChunkNode));
+
+    addNode(SampleChunkNode::s_gensRT, SampleChunkNode::s_optimizedVertexFormat);
+    addNode(SampleChunkNode::s_topology, SampleChunkNode::s_triangleList);
+
+    if (!adjacencies.empty())
+    {
+        std::vector<uint8_t> table(sizeof(SampleChunkAdjacencyTable) + adjacencies.size() * sizeof(SampleChunkAdjacency));
+        write32(table.data(), static_cast<uint32_t>(adjacencies.size()));
+
+        const uint32_t tableOffset = file.append(table.data(), static_cast<uint32_t>(table.size()));
+
+        for (size_t i = 0; i < adjacencies.size(); i++)
+        {
+            const uint32_t entry = tableOffset + static_cast<uint32_t>(sizeof(SampleChunkAdjacencyTable) + i * sizeof(SampleChunkAdjacency));
+
+            file.setPointer(entry + offsetof(SampleChunkAdjacency, mesh), adjacencies[i].mesh);
+            file.setPointer(entry + offsetof(SampleChunkAdjacency, data), adjacencies[i].data);
+            file.set(entry + offsetof(SampleChunkAdjacency, byteSize), adjacencies[i].byteSize);
+        }
+
+        nodeRelocations.push_back(static_cast<uint32_t>(nodes.size() * sizeof(SampleChunkNode) + offsetof(SampleChunkNode, value)));
+        addNode(SampleChunkNode::s_adjacencyTable, nodeSize + tableOffset);
+    }
+
+    // The contexts node contains the model data
+    addNode(SampleChunkNode::s_contexts, 5);
+    write32(reinterpret_cast<uint8_t*>(&nodes.back().flagsAndSize), sizeof(SampleChunkNode) + ((file.getSize() + 3) & ~3));
+
+    std::vector<uint8_t> output;
+    file.save(output, nodes, nodeRelocations);
+
+    FILE* outputFile = fopen(outputPath.string().c_str(), "wb");
+    if (outputFile == nullptr)
+    {
+        fprintf(stderr, "Unable to create %s\n", outputPath.string().c_str());
+        return false;
+    }
+
+    const bool written = fwrite(output.data(), 1, output.size(), outputFile) == output.size();
+    fclose(outputFile);
+
+    if (!written)
+    {
+        fprintf(stderr, "Unable to write %s\n", outputPath.string().c_str());
+        return false;
+    }
+
+    printf("%s: %zu meshes, %zu with adjacency, %u vertices welded, %zu -> %zu bytes\n",
+        path.c_str(), meshes.size(), adjacencies.size(), weldedVertexCount, input.size(), output.size());
+
+    return true;
+}
+
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::filesystem::path> inputPaths;
+    std::filesystem::path outputDirectory;
+    bool weld = false;
+    bool reorder = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--output") == 0 && i + 1 < argc)
+            outputDirectory = argv[++i];
+        else if (strcmp(argv[i], "--weld") == 0)
+            weld = true;
+        else if (strcmp(argv[i], "--reorder") == 0)
+            reorder = true;
+        else
+            inputPaths.emplace_back(argv[i]);
+    }
+
+    if (inputPaths.empty())
+    {
+        fprintf(stderr, "Usage: %s <input file or directory>... [--output <directory>] [--weld] [--reorder]\n", argv[0]);
+        return 1;
+    }
+
+    // Files get converted in place unless there is an output directory
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> files;
+    std::error_code error;
+
+    if (!outputDirectory.empty())
+        std::filesystem::create_directories(outputDirectory, error);
+
+    for (const auto& inputPath : inputPaths)
+    {
+        if (std::filesystem::is_directory(inputPath))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(inputPath))
+            {
+                if (entry.is_regular_file() && isModelFile(entry.path()))
+                {
+                    files.emplace_back(entry.path(), outputDirectory.empty() ? entry.path() :
+                        outputDirectory / std::filesystem::relative(entry.path(), inputPath));
+                }
+            }
+        }
+        else
+        {
+            files.emplace_back(inputPath, outputDirectory.empty() ? inputPath : outputDirectory / inputPath.filename());
+        }
+    }
+
+    uint32_t failedCount = 0;
+
+    for (const auto& [inputPath, outputPath] : files)
+    {
+        if (outputPath.has_parent_path())
+            std::filesystem::create_directories(outputPath.parent_path(), error);
+
+        if (!convertFile(inputPath, outputPath, weld, reorder))
+            ++failedCount;
+    }
+
+    printf("Converted %zu of %zu files\n", files.size() - failedCount, files.size());
+
+    return failedCount != 0 ? 1 : 0;
+}
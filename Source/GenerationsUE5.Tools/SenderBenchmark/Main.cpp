@@ -0,0 +1,227 @@
+#include <Configuration.h>
+#include <LockGuard.h>
+#include <Message.h>
+#include <MessageInfo.h>
+#include <MessageSender.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Measures MessageSender::makeMessage under contention, comparing the lock-free
+// reservation against the mutex guarded one it replaced. Producer threads make
+// vertex buffer writes while a drain thread stands in for the bridge and checks
+// that every message arrives intact.
+// Usage: SenderBenchmark [max thread count] [messages per thread] [message size]
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t s_alignment = 0x10;
+
+class BenchmarkSender : public MessageSender
+{
+public:
+    // makeMessage before the lock-free reservation, every message takes the mutex
+    void* makeMessageLocked(uint32_t byteSize, uint32_t alignment)
+    {
+        LockGuard lock(m_mutex);
+
+        auto alignOffset = [&](uint32_t offset)
+        {
+            if ((offset & (alignment - 1)) != 0)
+                offset = (offset + offsetof(MsgPadding, data) + alignment - 1) & ~(alignment - 1);
+
+            return offset;
+        };
+
+        uint32_t offset = m_offset.load(std::memory_order_relaxed);
+        uint32_t alignedOffset = alignOffset(offset);
+
+        if (alignedOffset + byteSize > MemoryMappedFile::s_size - sizeof(MsgPayloadFence))
+        {
+            commitMessages();
+            offset = m_offset.load(std::memory_order_relaxed);
+            alignedOffset = alignOffset(offset);
+        }
+
+        if (offset != alignedOffset)
+        {
+            const auto padding = reinterpret_cast<MsgPadding*>(&m_messages[offset]);
+            padding->id = MsgPadding::s_id;
+            padding->dataSize = static_cast<uint8_t>(alignedOffset - (offset + offsetof(MsgPadding, data)));
+        }
+
+        m_offset.store(alignedOffset + byteSize, std::memory_order_relaxed);
+        ++m_pendingMessages;
+
+        return &m_messages[alignedOffset];
+    }
+};
+
+struct DrainStats
+{
+    uint64_t messageCount;
+    uint64_t corruptCount;
+};
+
+// Copies batches out like the bridge does, an empty batch stops it
+static void drain(DrainStats& stats)
+{
+    const MessageInfo& info = s_messageInfos[MsgWriteVertexBuffer::s_id];
+
+    Event cpuEvent(Event::s_cpuEventName);
+    Event gpuEvent(Event::s_gpuEventName);
+    MemoryMappedFile file;
+
+    auto memoryMap = static_cast<uint8_t*>(file.map());
+    std::vector<uint8_t> messages(MemoryMappedFile::s_size);
+
+    while (true)
+    {
+        cpuEvent.wait();
+        cpuEvent.reset();
+
+        const uint32_t byteSize = *reinterpret_cast<const uint32_t*>(memoryMap);
+        memcpy(messages.data(), memoryMap, byteSize);
+
+        gpuEvent.set();
+
+        if (byteSize <= sizeof(uint32_t))
+            break;
+
+        uint32_t offset = sizeof(uint32_t);
+
+        while (offset < byteSize)
+        {
+            const MessageInfo* messageInfo = MessageInfo::get(messages[offset]);
+            if (messageInfo == nullptr)
+            {
+                ++stats.corruptCount;
+                break;
+            }
+
+            if (messages[offset] == MsgWriteVertexBuffer::s_id)
+            {
+                uint32_t vertexBufferId;
+                memcpy(&vertexBufferId, &messages[offset + offsetof(MsgWriteVertexBuffer, vertexBufferId)], sizeof(vertexBufferId));
+
+                // Every producer fills the data with its own id
+                const uint8_t* data = &messages[offset + info.headerSize];
+                const uint32_t dataSize = messageInfo->getByteSize(&messages[offset]) - info.headerSize;
+
+                for (uint32_t i = 0; i < dataSize; i++)
+                {
+                    if (data[i] != static_cast<uint8_t>(vertexBufferId))
+                    {
+                        ++stats.corruptCount;
+                        break;
+                    }
+                }
+
+                ++stats.messageCount;
+            }
+
+            offset += messageInfo->getByteSize(&messages[offset]);
+        }
+    }
+
+    file.unmap(memoryMap);
+}
+
+static double run(BenchmarkSender& sender, bool locked, uint32_t threadCount, uint32_t messageCount, uint32_t messageSize, DrainStats& stats)
+{
+    const MessageInfo& info = s_messageInfos[MsgWriteVertexBuffer::s_id];
+    const uint32_t byteSize = info.headerSize + messageSize;
+
+    stats = {};
+    std::thread drainThread(drain, std::ref(stats));
+
+    std::vector<std::thread> threads;
+    const auto begin = Clock::now();
+
+    for (uint32_t i = 0; i < threadCount; i++)
+    {
+        threads.emplace_back([&, i]
+        {
+            for (uint32_t j = 0; j < messageCount; j++)
+            {
+                // Lays out the header by hand, GCC and Clang ignore alignas on members of packed structs
+                auto message = static_cast<uint8_t*>(locked ?
+                    sender.makeMessageLocked(byteSize, s_alignment) : sender.makeMessage(byteSize, s_alignment));
+
+                memset(message, 0, info.headerSize);
+                message[0] = MsgWriteVertexBuffer::s_id;
+                memcpy(message + offsetof(MsgWriteVertexBuffer, vertexBufferId), &i, sizeof(i));
+                memcpy(message + info.dataSizeOffset, &messageSize, sizeof(messageSize));
+                memset(message + info.headerSize, static_cast<int>(i), messageSize);
+
+                sender.endMessage();
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    sender.commitMessages();
+    const double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+
+    // Nothing is pending anymore, the empty batch lets the drain thread exit
+    sender.commitMessages();
+    drainThread.join();
+
+    return seconds;
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t maxThreadCount = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) :
+        std::max(std::thread::hardware_concurrency(), 1u);
+
+    const uint32_t messageCount = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 200000;
+    const uint32_t messageSize = argc > 3 ? static_cast<uint32_t>(strtoul(argv[3], nullptr, 10)) : 0x40;
+
+    if (maxThreadCount == 0 || messageSize > 0x10000)
+    {
+        printf("Thread count needs to be non-zero and the message size at most 64 KB\n");
+        return 1;
+    }
+
+    auto sender = std::make_unique<BenchmarkSender>();
+    sender->init();
+
+    printf("%u messages of %u bytes per thread\n\n", messageCount, messageSize);
+    printf("%-8s %16s %16s %8s\n", "Threads", "Locked", "Lock-free", "Speedup");
+
+    bool success = true;
+
+    for (uint32_t threadCount = 1; threadCount <= maxThreadCount; threadCount *= 2)
+    {
+        const uint64_t expectedCount = static_cast<uint64_t>(threadCount) * messageCount;
+        double rates[2];
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            DrainStats stats;
+            const double seconds = run(*sender, i == 0, threadCount, messageCount, messageSize, stats);
+            rates[i] = static_cast<double>(expectedCount) / seconds / 1000000.0;
+
+            if (stats.messageCount != expectedCount || stats.corruptCount != 0)
+            {
+                printf("%s on %u threads: %llu of %llu messages arrived, %llu corrupt\n", i == 0 ? "Locked" : "Lock-free", threadCount,
+                    static_cast<unsigned long long>(stats.messageCount), static_cast<unsigned long long>(expectedCount),
+                    static_cast<unsigned long long>(stats.corruptCount));
+
+                success = false;
+            }
+        }
+
+        printf("%-8u %11.2f M/s %11.2f M/s %7.2fx\n", threadCount, rates[0], rates[1], rates[1] / rates[0]);
+    }
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// Stand-in for the X86 precompiled header, lets the transport sources of the
+// game side (MessageSender, PayloadHeap) build against the POSIX primitives.
+
+#include <Platform.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+
+#include <sched.h>
+
+inline void YieldProcessor()
+{
+#if defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#endif
+}
+
+inline void SwitchToThread()
+{
+    sched_yield();
+}
+
+inline void* _aligned_malloc(size_t size, size_t alignment)
+{
+    return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+}
+
+inline void _aligned_free(void* memory)
+{
+    free(memory);
+}
+
+#endif
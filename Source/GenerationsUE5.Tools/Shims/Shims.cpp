@@ -0,0 +1,27 @@
+#include "Logger.h"
+#include "MessageTelemetry.h"
+
+#include <cstdarg>
+
+// Logging goes to the console and telemetry is left out, neither has an overlay to report to here
+
+void Logger::log(LogType logType, const char* text)
+{
+    fprintf(logType == LogType::Error || logType == LogType::Warning ? stderr : stdout, "%s\n", text);
+}
+
+void Logger::logFormatted(LogType logType, const char* format, ...)
+{
+    char text[0x400];
+
+    va_list args;
+    va_start(args, format);
+    vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+
+    log(logType, text);
+}
+
+void MessageTelemetry::record(const uint8_t*, uint32_t)
+{
+}
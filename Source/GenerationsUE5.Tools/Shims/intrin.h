@@ -0,0 +1,18 @@
+#pragma once
+
+// Stand-in for the MSVC intrinsics header on GCC and Clang
+
+#include <cpuid.h>
+#include <x86intrin.h>
+
+// cpuid.h defines a macro of the same name with a different signature
+#undef __cpuid
+
+inline void __cpuid(int cpuInfo[4], int function)
+{
+    unsigned int registers[4]{};
+    __get_cpuid(static_cast<unsigned int>(function), &registers[0], &registers[1], &registers[2], &registers[3]);
+
+    for (size_t i = 0; i < 4; i++)
+        cpuInfo[i] = static_cast<int>(registers[i]);
+}
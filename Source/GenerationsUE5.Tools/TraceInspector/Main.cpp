@@ -0,0 +1,194 @@
+#include <Message.h>
+#include <MessageInfo.h>
+#include <MessageTrace.h>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// Walks the command stream of a .gensrt capture and prints statistics about it.
+// Usage: TraceInspector <trace.gensrt> [--frames]
+
+struct MessageStats
+{
+    uint64_t count;
+    uint64_t byteSize;
+};
+
+struct FrameStats
+{
+    uint32_t messageCount;
+    uint32_t paddingSize;
+};
+
+static MessageInfo getMessageInfo(uint32_t id, bool debugLayout)
+{
+    MessageInfo info = *MessageInfo::get(id);
+
+    // Debug builds store the texture name in front of the data size
+    if (debugLayout && id == MsgMakeTexture::s_id)
+    {
+        info.headerSize += 0x100;
+        info.dataSizeOffset += 0x100;
+    }
+
+    return info;
+}
+
+static bool walkFrame(const MessageTraceFrame& frame, const uint8_t* data, bool debugLayout,
+    std::vector<MessageStats>& messageStats, FrameStats& frameStats)
+{
+    if (frame.byteSize < sizeof(uint32_t) || *reinterpret_cast<const uint32_t*>(data) != frame.byteSize)
+    {
+        fprintf(stderr, "Frame %u: size header does not match the frame size\n", frame.frameIndex);
+        return false;
+    }
+
+    uint32_t offset = sizeof(uint32_t);
+
+    while (offset < frame.byteSize)
+    {
+        const uint8_t id = data[offset];
+        if (id >= messageStats.size())
+        {
+            fprintf(stderr, "Frame %u: unknown message id %u at offset 0x%X\n", frame.frameIndex, id, offset);
+            return false;
+        }
+
+        const MessageInfo info = getMessageInfo(id, debugLayout);
+        if (offset + info.headerSize > frame.byteSize)
+        {
+            fprintf(stderr, "Frame %u: %s at offset 0x%X is truncated\n", frame.frameIndex, info.name, offset);
+            return false;
+        }
+
+        const uint32_t byteSize = info.getByteSize(data + offset);
+        if (offset + byteSize > frame.byteSize)
+        {
+            fprintf(stderr, "Frame %u: %s at offset 0x%X overruns the frame\n", frame.frameIndex, info.name, offset);
+            return false;
+        }
+
+        if (id == MsgPadding::s_id)
+        {
+            frameStats.paddingSize += byteSize;
+        }
+        else
+        {
+            ++frameStats.messageCount;
+        }
+
+        ++messageStats[id].count;
+        messageStats[id].byteSize += byteSize;
+
+        offset += byteSize;
+    }
+
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace.gensrt> [--frames]\n", argv[0]);
+        return 1;
+    }
+
+    const bool printFrames = argc > 2 && strcmp(argv[2], "--frames") == 0;
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Unable to open %s\n", argv[1]);
+        return 1;
+    }
+
+    MessageTraceHeader header{};
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != MessageTraceHeader::s_magic)
+    {
+        fprintf(stderr, "%s is not a message trace\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+
+    if (header.version != MessageTraceHeader::s_version)
+    {
+        fprintf(stderr, "Unsupported trace version %u\n", header.version);
+        fclose(file);
+        return 1;
+    }
+
+    if (header.messageCount != std::size(s_messageInfos))
+    {
+        fprintf(stderr, "Warning: trace was written with %u message types, this tool knows %u\n",
+            header.messageCount, static_cast<uint32_t>(std::size(s_messageInfos)));
+    }
+
+    std::vector<MessageStats> messageStats(std::size(s_messageInfos));
+    std::vector<uint8_t> data;
+
+    uint32_t frameCount = 0;
+    uint64_t totalSize = 0;
+    uint32_t maxSize = 0;
+    bool success = true;
+
+    MessageTraceFrame frame{};
+    while (fread(&frame, sizeof(frame), 1, file) == 1)
+    {
+        data.resize(frame.byteSize);
+        if (fread(data.data(), 1, frame.byteSize, file) != frame.byteSize)
+        {
+            fprintf(stderr, "Frame %u is truncated\n", frame.frameIndex);
+            success = false;
+            break;
+        }
+
+        FrameStats frameStats{};
+        if (!walkFrame(frame, data.data(), header.debugLayout != 0, messageStats, frameStats))
+        {
+            success = false;
+            break;
+        }
+
+        if (printFrames)
+        {
+            printf("Frame %u: %u bytes, %u messages, %u padding bytes\n",
+                frame.frameIndex, frame.byteSize, frameStats.messageCount, frameStats.paddingSize);
+        }
+
+        ++frameCount;
+        totalSize += frame.byteSize;
+        maxSize = frame.byteSize > maxSize ? frame.byteSize : maxSize;
+    }
+
+    fclose(file);
+
+    if (frameCount == 0)
+    {
+        printf("No frames\n");
+        return success ? 0 : 1;
+    }
+
+    printf("%u frames, %.3f MB total, %.3f MB average, %.3f MB max\n\n", frameCount,
+        static_cast<double>(totalSize) / (1024.0 * 1024.0),
+        static_cast<double>(totalSize) / (1024.0 * 1024.0 * frameCount),
+        static_cast<double>(maxSize) / (1024.0 * 1024.0));
+
+    printf("%-36s %12s %14s %12s %12s\n", "Message", "Count", "Bytes", "Per Frame", "Avg Size");
+
+    for (uint32_t i = 0; i < messageStats.size(); i++)
+    {
+        const MessageStats& stats = messageStats[i];
+        if (stats.count == 0)
+            continue;
+
+        printf("%-36s %12llu %14llu %12.1f %12.1f\n", s_messageInfos[i].name,
+            static_cast<unsigned long long>(stats.count),
+            static_cast<unsigned long long>(stats.byteSize),
+            static_cast<double>(stats.count) / frameCount,
+            static_cast<double>(stats.byteSize) / stats.count);
+    }
+
+    return success ? 0 : 1;
+}
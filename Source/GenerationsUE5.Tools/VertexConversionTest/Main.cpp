@@ -0,0 +1,243 @@
+#include <VertexConversion.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+// Checks that the SSE4.1 kernels of VertexConversion produce the exact same bytes
+// as the scalar reference in MeshConversion. Sources mix random floats with NaN,
+// infinities, denormals, values around the half precision limits and all zero
+// vectors, over vertex counts that leave a tail for the scalar loop. Normals whose
+// quantization depends on the order the squared norm gets summed in are tested
+// separately, random ones rarely hit a rounding boundary.
+// Usage: VertexConversionTest [iterations] [seed]
+
+static const float s_specialValues[] =
+{
+    0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f,
+    std::numeric_limits<float>::quiet_NaN(),
+    -std::numeric_limits<float>::quiet_NaN(),
+    std::numeric_limits<float>::infinity(),
+    -std::numeric_limits<float>::infinity(),
+    std::numeric_limits<float>::denorm_min(),
+    -std::numeric_limits<float>::denorm_min(),
+    std::numeric_limits<float>::min() * 0.5f,
+    std::numeric_limits<float>::min(),
+    std::numeric_limits<float>::max(),
+    65504.0f, 65520.0f, -65536.0f,
+    6.1e-5f, 5.96e-8f, 1e-20f, 1e30f,
+};
+
+static uint32_t makeValue(std::mt19937& random)
+{
+    float value;
+
+    switch (random() % 4)
+    {
+    case 0:
+        value = s_specialValues[random() % std::size(s_specialValues)];
+        break;
+
+    case 1:
+        value = std::uniform_real_distribution<float>(-2.0f, 2.0f)(random);
+        break;
+
+    case 2:
+        value = std::uniform_real_distribution<float>(-70000.0f, 70000.0f)(random);
+        break;
+
+    default:
+        // Any bit pattern, including signaling NaN and packed normals
+        return random();
+    }
+
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static void storeBigEndian(uint8_t* destination, uint32_t value)
+{
+    for (size_t i = 0; i < 4; i++)
+        destination[i] = static_cast<uint8_t>(value >> (24 - i * 8));
+}
+
+static uint32_t loadBigEndian(const uint8_t* source)
+{
+    return (source[0] << 24) | (source[1] << 16) | (source[2] << 8) | source[3];
+}
+
+// Sums the squared norm left to right instead of the way Eigen does it
+static uint32_t normalizeAndQuantizeLeftToRight(float x, float y, float z)
+{
+    const float squaredNorm = (x * x + y * y) + z * z;
+    if (squaredNorm > 0.0f)
+    {
+        const float norm = std::sqrt(squaredNorm);
+        x /= norm;
+        y /= norm;
+        z /= norm;
+    }
+
+    return (quantizeUnorm(x * 0.5f + 0.5f, 10) & 0x3FF) |
+        ((quantizeUnorm(y * 0.5f + 0.5f, 10) & 0x3FF) << 10) |
+        ((quantizeUnorm(z * 0.5f + 0.5f, 10) & 0x3FF) << 20);
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 50000;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 0;
+
+    if (!VertexConversion::isSimdSupported())
+    {
+        printf("SSSE3 and SSE4.1 are not supported, nothing to test\n");
+        return 0;
+    }
+
+    std::mt19937 random(seed);
+
+    const VertexConversionType types[] =
+    {
+        VertexConversionType::Swap32,
+        VertexConversionType::Swap32x3,
+        VertexConversionType::Swap16x2,
+        VertexConversionType::Float3ToUdec3n,
+        VertexConversionType::Dec3nToUdec3n,
+        VertexConversionType::Float2ToHalf2,
+        VertexConversionType::Float4ToUbyte4n,
+    };
+
+    uint32_t mismatchCount = 0;
+    uint64_t vertexCount = 0;
+
+    std::vector<uint8_t> source;
+    std::vector<uint8_t> expected;
+    std::vector<uint8_t> result;
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const VertexConversionType type = types[random() % std::size(types)];
+        const uint32_t count = random() % 37;
+        const uint32_t sourceStride = 16 + 4 * (random() % 8);
+        const uint32_t destinationStride = 16 + 4 * (random() % 4);
+
+        source.resize(count * sourceStride);
+        for (uint32_t j = 0; j < count * sourceStride; j += 4)
+            storeBigEndian(&source[j], makeValue(random));
+
+        // Vectors of zero length are left unnormalized
+        if (random() % 8 == 0)
+        {
+            for (uint32_t j = 0; j < count; j++)
+            {
+                if (random() % 2 == 0)
+                    memset(&source[j * sourceStride], random() % 2 == 0 ? 0x00 : 0x80, 12);
+            }
+        }
+
+        // Bytes between the elements need to stay untouched
+        expected.assign(count * destinationStride, 0xCD);
+        result.assign(count * destinationStride, 0xCD);
+
+        MeshConversion::convertScalar(type, { source.data(), sourceStride, expected.data(), destinationStride, count });
+        VertexConversion::convertSimd(type, { source.data(), sourceStride, result.data(), destinationStride, count });
+
+        if (expected != result)
+        {
+            for (uint32_t j = 0; j < count; j++)
+            {
+                if (memcmp(&expected[j * destinationStride], &result[j * destinationStride], destinationStride) == 0)
+                    continue;
+
+                if (mismatchCount < 10)
+                {
+                    uint32_t value[3];
+                    for (size_t k = 0; k < 3; k++)
+                        value[k] = loadBigEndian(&source[j * sourceStride + k * 4]);
+
+                    uint32_t expectedValue, resultValue;
+                    memcpy(&expectedValue, &expected[j * destinationStride], sizeof(uint32_t));
+                    memcpy(&resultValue, &result[j * destinationStride], sizeof(uint32_t));
+
+                    printf("Type %d vertex %u of %u: source %08X %08X %08X, expected %08X, got %08X\n", static_cast<int>(type), j, count,
+                        value[0], value[1], value[2], expectedValue, resultValue);
+                }
+
+                ++mismatchCount;
+                break;
+            }
+        }
+
+        vertexCount += count;
+    }
+
+    std::vector<float> normals;
+
+    for (uint32_t i = 0; i < 20000000 && normals.size() < 3 * 64; i++)
+    {
+        std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+        const float x = distribution(random);
+        const float y = distribution(random);
+        const float z = distribution(random);
+
+        if (MeshConversionDetail::normalizeAndQuantizeSnorm10(x, y, z) != normalizeAndQuantizeLeftToRight(x, y, z))
+            normals.insert(normals.end(), { x, y, z });
+    }
+
+    const uint32_t normalCount = static_cast<uint32_t>(normals.size() / 3);
+
+    source.resize(normals.size() * sizeof(float));
+    for (size_t i = 0; i < normals.size(); i++)
+    {
+        uint32_t value;
+        memcpy(&value, &normals[i], sizeof(value));
+        storeBigEndian(&source[i * sizeof(float)], value);
+    }
+
+    expected.assign(normalCount * sizeof(uint32_t), 0xCD);
+    result.assign(normalCount * sizeof(uint32_t), 0xCD);
+
+    MeshConversion::convertScalar(VertexConversionType::Float3ToUdec3n, { source.data(), 12, expected.data(), 4, normalCount });
+    VertexConversion::convertSimd(VertexConversionType::Float3ToUdec3n, { source.data(), 12, result.data(), 4, normalCount });
+
+    uint32_t normalMismatchCount = 0;
+    for (uint32_t i = 0; i < normalCount; i++)
+    {
+        if (memcmp(&expected[i * 4], &result[i * 4], 4) != 0)
+            ++normalMismatchCount;
+    }
+
+    printf("%u normals that depend on the summation order, %u mismatches\n", normalCount, normalMismatchCount);
+
+    // Sizes that aren't a multiple of 16 bytes leave a tail for the scalar loop
+    uint32_t byteSwapMismatchCount = 0;
+
+    for (uint32_t byteSize = 0; byteSize <= 256; byteSize += 4)
+    {
+        source.resize(byteSize);
+        for (auto& value : source)
+            value = static_cast<uint8_t>(random());
+
+        expected.assign(byteSize, 0xCD);
+        result.assign(byteSize, 0xCD);
+
+        MeshConversion::byteSwap32Scalar(expected.data(), source.data(), byteSize);
+        VertexConversion::byteSwap32Simd(result.data(), source.data(), byteSize);
+
+        if (expected != result)
+        {
+            printf("byteSwap32Simd differs for %u bytes\n", byteSize);
+            ++byteSwapMismatchCount;
+        }
+    }
+
+    printf("%llu vertices over %u streams, %u mismatches, byte swaps %s\n", static_cast<unsigned long long>(vertexCount),
+        iterations, mismatchCount, byteSwapMismatchCount == 0 ? "OK" : "FAILED");
+
+    return mismatchCount == 0 && normalMismatchCount == 0 && byteSwapMismatchCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,146 @@
+#include <WriteCombiner.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// Checks that the ranges WriteCombiner merges and sends on flush produce the same
+// buffer contents as sending every lock as is. Locks overlap, touch or stay clear
+// of earlier ones, every flush also checks that the sent ranges are sorted, never
+// touch each other and cover exactly the bytes written since the previous flush.
+// Usage: WriteCombinerTest [iterations] [seed]
+
+static constexpr uint32_t s_bufferCount = 2;
+static constexpr uint32_t s_byteSize = 0x1000;
+
+struct Send
+{
+    uint32_t offset;
+    uint32_t byteSize;
+};
+
+// What the bridge ends up with, along with the sends since the last flush
+static std::vector<uint8_t> s_bridgeData[s_bufferCount];
+static std::vector<Send> s_sends[s_bufferCount];
+
+static void send(uint32_t id, uint32_t offset, const uint8_t* data, uint32_t byteSize)
+{
+    memcpy(s_bridgeData[id].data() + offset, data, byteSize);
+    s_sends[id].push_back({ offset, byteSize });
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(strtoul(argv[1], nullptr, 10)) : 20000;
+    const uint32_t seed = argc > 2 ? static_cast<uint32_t>(strtoul(argv[2], nullptr, 10)) : 0;
+
+    std::mt19937 random(seed);
+
+    std::vector<uint8_t> expectedData[s_bufferCount];
+    std::vector<bool> written[s_bufferCount];
+    std::vector<std::unique_ptr<WriteCombiner>> writeCombiners;
+
+    for (uint32_t i = 0; i < s_bufferCount; i++)
+    {
+        s_bridgeData[i].resize(s_byteSize);
+        expectedData[i].resize(s_byteSize);
+        written[i].resize(s_byteSize);
+        writeCombiners.push_back(std::make_unique<WriteCombiner>(i, s_byteSize, send));
+    }
+
+    uint32_t prevBegin[s_bufferCount]{};
+    uint32_t prevEnd[s_bufferCount]{};
+    uint32_t flushCount = 0;
+    uint32_t sendCount = 0;
+    uint32_t lockCount = 0;
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        const uint32_t id = random() % s_bufferCount;
+        const uint32_t byteSize = 1 + random() % 0x100;
+        uint32_t offset;
+
+        switch (random() % 4)
+        {
+        case 0:
+            // Overlaps the previous lock
+            offset = prevBegin[id] + random() % (prevEnd[id] - prevBegin[id] + 1);
+            break;
+
+        case 1:
+            // Starts right where the previous lock ended
+            offset = prevEnd[id];
+            break;
+
+        case 2:
+            // Ends right where the previous lock began
+            offset = prevBegin[id] >= byteSize ? prevBegin[id] - byteSize : 0;
+            break;
+
+        default:
+            offset = random() % s_byteSize;
+            break;
+        }
+
+        offset = std::min(offset, s_byteSize - byteSize);
+
+        uint8_t* data = writeCombiners[id]->lock(offset, byteSize);
+
+        for (uint32_t j = 0; j < byteSize; j++)
+        {
+            data[j] = static_cast<uint8_t>(random());
+            expectedData[id][offset + j] = data[j];
+            written[id][offset + j] = true;
+        }
+
+        writeCombiners[id]->unlock();
+
+        prevBegin[id] = offset;
+        prevEnd[id] = offset + byteSize;
+        ++lockCount;
+
+        if (random() % 16 != 0 && i + 1 != iterations)
+            continue;
+
+        WriteCombiner::flush();
+        ++flushCount;
+
+        for (uint32_t j = 0; j < s_bufferCount; j++)
+        {
+            if (s_bridgeData[j] != expectedData[j])
+            {
+                printf("Buffer %u differs after flush %u\n", j, flushCount);
+                return 1;
+            }
+
+            std::vector<bool> sent(s_byteSize);
+
+            for (size_t k = 0; k < s_sends[j].size(); k++)
+            {
+                const auto& current = s_sends[j][k];
+
+                if (k != 0 && s_sends[j][k - 1].offset + s_sends[j][k - 1].byteSize >= current.offset)
+                {
+                    printf("Buffer %u sent unsorted or unmerged ranges in flush %u\n", j, flushCount);
+                    return 1;
+                }
+
+                std::fill(sent.begin() + current.offset, sent.begin() + current.offset + current.byteSize, true);
+            }
+
+            if (sent != written[j])
+            {
+                printf("Buffer %u sent ranges that don't match the locks in flush %u\n", j, flushCount);
+                return 1;
+            }
+
+            sendCount += static_cast<uint32_t>(s_sends[j].size());
+            s_sends[j].clear();
+            std::fill(written[j].begin(), written[j].end(), false);
+        }
+    }
+
+    printf("%u locks merged into %u sends over %u flushes: OK\n", lockCount, sendCount, flushCount);
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include "BufferPool.h"
+
+#include "Configuration.h"
+#include "LockGuard.h"
+#include "Message.h"
+#include "MessageSender.h"
+
+// Vertex and index buffer heaps share the same id space on the bridge
+static std::atomic<uint32_t> s_heapIdCounter;
+
+bool BufferPool::shouldUse(uint32_t byteSize) const
+{
+    return Configuration::s_poolSmallBuffers && byteSize <= std::min(Configuration::s_bufferPoolThreshold, s_heapSize);
+}
+
+BufferPoolAllocation BufferPool::allocate(uint32_t byteSize)
+{
+    LockGuard lock(m_mutex);
+
+    BufferPoolAllocation allocation{};
+    allocation.offset = BuddyAllocator::s_invalidOffset;
+
+    for (auto& heap : m_heaps)
+    {
+        allocation.offset = heap.allocator.allocate(byteSize);
+        if (allocation.offset != BuddyAllocator::s_invalidOffset)
+        {
+            allocation.heapId = heap.id;
+            break;
+        }
+    }
+
+    if (allocation.offset == BuddyAllocator::s_invalidOffset)
+    {
+        auto& heap = m_heaps.emplace_back(Heap{ ++s_heapIdCounter, BuddyAllocator(s_heapSize, s_minBlockSize) });
+
+        auto& message = s_messageSender.makeMessage<MsgCreateBufferHeap>();
+        message.heapId = heap.id;
+        message.length = s_heapSize;
+        s_messageSender.endMessage();
+
+        allocation.heapId = heap.id;
+        allocation.offset = heap.allocator.allocate(byteSize);
+    }
+
+    const uint32_t blockSize = m_heaps.front().allocator.getBlockSize(byteSize);
+    m_usedMemory += blockSize;
+    m_wastedMemory += blockSize - byteSize;
+
+    return allocation;
+}
+
+void BufferPool::free(const BufferPoolAllocation& allocation, uint32_t byteSize)
+{
+    LockGuard lock(m_mutex);
+
+    for (uint32_t i = 0; i < m_heaps.size(); i++)
+    {
+        if (m_heaps[i].id == allocation.heapId)
+        {
+            m_pendingFrees.push_back({ i, allocation.offset, m_frame });
+            break;
+        }
+    }
+
+    m_wastedMemory -= m_heaps.front().allocator.getBlockSize(byteSize) - byteSize;
+}
+
+void BufferPool::nextFrame()
+{
+    LockGuard lock(m_mutex);
+
+    ++m_frame;
+
+    m_pendingFrees.erase(std::remove_if(m_pendingFrees.begin(), m_pendingFrees.end(), [&](const PendingFree& pendingFree)
+    {
+        if (m_frame - pendingFree.frame < s_frameLatency)
+            return false;
+
+        m_usedMemory -= m_heaps[pendingFree.heapIndex].allocator.free(pendingFree.offset);
+        return true;
+    }), m_pendingFrees.end());
+}
+
+uint32_t BufferPool::getHeapCount()
+{
+    LockGuard lock(m_mutex);
+    return static_cast<uint32_t>(m_heaps.size());
+}
+
+uint32_t BufferPool::getUsedMemory() const
+{
+    return m_usedMemory;
+}
+
+uint32_t BufferPool::getWastedMemory() const
+{
+    return m_wastedMemory;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "BuddyAllocator.h"
+#include "Mutex.h"
+
+struct BufferPoolAllocation
+{
+    uint32_t heapId;
+    uint32_t offset;
+};
+
+// Suballocates small buffers from large heaps on the bridge, which would otherwise
+// round every one of them up to a 64 KB allocation. Freed blocks are held back for
+// a few frames, as the GPU might still be reading the buffer that occupied them.
+class BufferPool
+{
+protected:
+    static constexpr uint32_t s_heapSize = 0x400000;
+    static constexpr uint32_t s_minBlockSize = 0x100;
+    static constexpr uint32_t s_frameLatency = 3;
+
+    struct Heap
+    {
+        uint32_t id;
+        BuddyAllocator allocator;
+    };
+
+    struct PendingFree
+    {
+        uint32_t heapIndex;
+        uint32_t offset;
+        uint32_t frame;
+    };
+
+    Mutex m_mutex;
+    std::vector<Heap> m_heaps;
+    std::vector<PendingFree> m_pendingFrees;
+    uint32_t m_frame = 0;
+
+    std::atomic<uint32_t> m_usedMemory;
+    std::atomic<uint32_t> m_wastedMemory;
+
+public:
+    bool shouldUse(uint32_t byteSize) const;
+
+    BufferPoolAllocation allocate(uint32_t byteSize);
+    void free(const BufferPoolAllocation& allocation, uint32_t byteSize);
+
+    // Releases the blocks that are no longer in flight
+    void nextFrame();
+
+    uint32_t getHeapCount();
+    uint32_t getUsedMemory() const;
+
+    // Memory lost to rounding buffers up to power of two blocks
+    uint32_t getWastedMemory() const;
+};
+
+inline BufferPool s_vertexBufferPool;
+inline BufferPool s_indexBufferPool;
@@ -19,5 +19,26 @@ void Configuration::init()
         s_toneMap = iniFile.getBool("Mod", "ToneMap", true);
         s_furStyle = static_cast<FurStyle>(iniFile.get<uint32_t>("Mod", "FurStyle", static_cast<uint32_t>(FurStyle::Frontiers)));
         s_hdr = iniFile.getBool("Mod", "HDR", false);
+        s_zeroCopyTransport = iniFile.getBool("Mod", "ZeroCopyTransport", false);
+        s_messageRingSlotCount = iniFile.get<uint32_t>("Mod", "MessageRingSlotCount", 2);
+        s_commitThreadDepth = iniFile.get<uint32_t>("Mod", "CommitThreadDepth", 0);
+        s_messageCaptureFilePath = iniFile.getString("Mod", "MessageCaptureFilePath", "");
+        s_payloadHeapSize = iniFile.get<uint32_t>("Mod", "PayloadHeapSize", 0);
+        s_payloadHeapThreshold = iniFile.get<uint32_t>("Mod", "PayloadHeapThreshold", 0x10000);
+        s_compressTextures = iniFile.getBool("Mod", "CompressTextures", false);
+        s_compressVertexBuffers = iniFile.getBool("Mod", "CompressVertexBuffers", false);
+        s_compressIndexBuffers = iniFile.getBool("Mod", "CompressIndexBuffers", false);
+        s_compressionThreshold = iniFile.get<uint32_t>("Mod", "CompressionThreshold", 0x10000);
+
+        s_mergeDrawCalls = iniFile.getBool("Mod", "MergeDrawCalls", false);
+        s_writeCombineBuffers = iniFile.getBool("Mod", "WriteCombineBuffers", false);
+        s_reorderTriangles = iniFile.getBool("Mod", "ReorderTriangles", false);
+        s_weldVertices = iniFile.getBool("Mod", "WeldVertices", false);
+        s_poolSmallBuffers = iniFile.getBool("Mod", "PoolSmallBuffers", false);
+        s_bufferPoolThreshold = iniFile.get<uint32_t>("Mod", "BufferPoolThreshold", 0x8000);
+
+        s_transientRingSize = iniFile.get<uint32_t>("Mod", "TransientRingSize", 0);
+
+        s_persistentShaderCache = iniFile.getBool("Mod", "PersistentShaderCache", false);
     }
 }
@@ -37,5 +37,28 @@ public:
 
     static inline bool s_enableImgui;
 
+    static inline bool s_zeroCopyTransport;
+    static inline uint32_t s_messageRingSlotCount = 2;
+    static inline uint32_t s_commitThreadDepth;
+    static inline std::string s_messageCaptureFilePath;
+    static inline uint32_t s_payloadHeapSize;
+    static inline uint32_t s_payloadHeapThreshold = 0x10000;
+
+    static inline bool s_compressTextures;
+    static inline bool s_compressVertexBuffers;
+    static inline bool s_compressIndexBuffers;
+    static inline uint32_t s_compressionThreshold = 0x10000;
+
+    static inline bool s_mergeDrawCalls;
+    static inline bool s_writeCombineBuffers;
+    static inline bool s_reorderTriangles;
+    static inline bool s_weldVertices;
+    static inline bool s_poolSmallBuffers;
+    static inline uint32_t s_bufferPoolThreshold = 0x8000;
+
+    static inline uint32_t s_transientRingSize;
+
+    static inline bool s_persistentShaderCache;
+
     static void init();
 };
\ No newline at end of file
@@ -6,11 +6,14 @@
 #include "MessageSender.h"
 #include "PixelShader.h"
 #include "RaytracingParams.h"
+#include "ShaderCache.h"
+#include "StateBlock.h"
 #include "Surface.h"
 #include "Texture.h"
 #include "VertexBuffer.h"
 #include "VertexDeclaration.h"
 #include "VertexShader.h"
+#include "WriteCombiner.h"
 #include "RaytracingUtil.h"
 
 void Device::createVertexDeclaration(const D3DVERTEXELEMENT9* pVertexElements, VertexDeclaration** ppDecl, bool isFVF)
@@ -157,17 +160,33 @@ void Device::renderImgui()
         return;
     }
 
-    if (!m_imgui.vertexBuffer || m_imgui.vertexBuffer->getByteSize() < vertexBufferSize)
-        CreateVertexBuffer(vertexBufferSize, D3DUSAGE_WRITEONLY, 0, D3DPOOL_MANAGED, m_imgui.vertexBuffer.ReleaseAndGetAddressOf(), nullptr);
+    VertexBuffer* vertexBuffer = nullptr;
+    IndexBuffer* indexBuffer = nullptr;
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
 
-    if (!m_imgui.indexBuffer || m_imgui.indexBuffer->getByteSize() < indexBufferSize)
-        CreateIndexBuffer(indexBufferSize, D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, m_imgui.indexBuffer.ReleaseAndGetAddressOf(), nullptr);
+    if (allocateTransient(vertexBufferSize, sizeof(ImDrawVert), indexBufferSize, vertexOffset, indexOffset))
+    {
+        vertexBuffer = m_transient.vertexBuffer.Get();
+        indexBuffer = m_transient.indexBuffer.Get();
+    }
+    else
+    {
+        if (!m_imgui.vertexBuffer || m_imgui.vertexBuffer->getByteSize() < vertexBufferSize)
+            CreateVertexBuffer(vertexBufferSize, D3DUSAGE_WRITEONLY, 0, D3DPOOL_MANAGED, m_imgui.vertexBuffer.ReleaseAndGetAddressOf(), nullptr);
+
+        if (!m_imgui.indexBuffer || m_imgui.indexBuffer->getByteSize() < indexBufferSize)
+            CreateIndexBuffer(indexBufferSize, D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_MANAGED, m_imgui.indexBuffer.ReleaseAndGetAddressOf(), nullptr);
+
+        vertexBuffer = m_imgui.vertexBuffer.Get();
+        indexBuffer = m_imgui.indexBuffer.Get();
+    }
 
     ImDrawVert* vtx = nullptr;
     ImDrawIdx* idx = nullptr;
 
-    m_imgui.vertexBuffer->Lock(0, vertexBufferSize, reinterpret_cast<void**>(&vtx), D3DLOCK_DISCARD);
-    m_imgui.indexBuffer->Lock(0, indexBufferSize, reinterpret_cast<void**>(&idx), D3DLOCK_DISCARD);
+    vertexBuffer->Lock(vertexOffset, vertexBufferSize, reinterpret_cast<void**>(&vtx), D3DLOCK_DISCARD);
+    indexBuffer->Lock(indexOffset, indexBufferSize, reinterpret_cast<void**>(&idx), D3DLOCK_DISCARD);
 
     for (int i = 0; i < drawData->CmdListsCount; i++)
     {
@@ -201,8 +220,8 @@ void Device::renderImgui()
         idx += drawList->IdxBuffer.Size;
     }
 
-    m_imgui.indexBuffer->Unlock();
-    m_imgui.vertexBuffer->Unlock();
+    indexBuffer->Unlock();
+    vertexBuffer->Unlock();
 
     D3DVIEWPORT9 viewport{};
     viewport.Width = static_cast<DWORD>(drawData->DisplaySize.x);
@@ -226,8 +245,8 @@ void Device::renderImgui()
     SetSamplerState(0, D3DSAMP_MAGFILTER, D3DTEXF_LINEAR);
     SetSamplerState(0, D3DSAMP_MIPFILTER, D3DTEXF_NONE);
     SetVertexDeclaration(m_imgui.vertexDeclaration.Get());
-    SetStreamSource(0, m_imgui.vertexBuffer.Get(), 0, sizeof(ImDrawVert));
-    SetIndices(m_imgui.indexBuffer.Get());
+    SetStreamSource(0, vertexBuffer, 0, sizeof(ImDrawVert));
+    SetIndices(indexBuffer);
 
     const float viewportSize[] = { drawData->DisplaySize.x, drawData->DisplaySize.y, 1.0f / drawData->DisplaySize.x, 1.0f / drawData->DisplaySize.y };
     constexpr float scaleSize[] = { 1.0f, 1.0f, 0.0f, 0.0f };
@@ -238,8 +257,8 @@ void Device::renderImgui()
     SetVertexShaderConstantF(247, scaleSize, 1);
 
     const ImVec2 clipOffset = drawData->DisplayPos;
-    size_t vtxOffset = 0;
-    size_t idxOffset = 0;
+    size_t vtxOffset = vertexOffset / sizeof(ImDrawVert);
+    size_t idxOffset = indexOffset / sizeof(ImDrawIdx);
 
     for (int i = 0; i < drawData->CmdListsCount; i++)
     {
@@ -404,6 +423,27 @@ void Device::storeIm3dDepthStencil()
     m_im3d.depthStencil = m_depthStencil;
 }
 
+template <typename TMessage, typename T>
+static void sendShaderConstants(uint32_t startRegister, const T* values, uint32_t count)
+{
+    auto& message = s_messageSender.makeMessage<TMessage>(count * sizeof(T));
+
+    message.startRegister = startRegister;
+    memcpy(message.data, values, count * sizeof(T));
+
+    s_messageSender.endMessage();
+}
+
+void Device::flushPendingState()
+{
+    WriteCombiner::flush();
+
+    m_vertexShaderConstantsF.flush(sendShaderConstants<MsgSetVertexShaderConstantF, float[4]>);
+    m_pixelShaderConstantsF.flush(sendShaderConstants<MsgSetPixelShaderConstantF, float[4]>);
+    m_vertexShaderConstantsB.flush(sendShaderConstants<MsgSetVertexShaderConstantB, BOOL>);
+    m_pixelShaderConstantsB.flush(sendShaderConstants<MsgSetPixelShaderConstantB, BOOL>);
+}
+
 FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::TestCooperativeLevel)
 
 FUNCTION_STUB(UINT, 0, Device::GetAvailableTextureMem)
@@ -434,6 +474,14 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::Reset, D3DPRESENT_PARAMETERS* pPresent
 
 HRESULT Device::Present(const RECT* pSourceRect, const RECT* pDestRect, HWND hDestWindowOverride, const RGNDATA* pDirtyRegion)
 {
+    // Don't let state set after the last draw call leak into the next frame
+    flushPendingState();
+
+    ShaderCache::processMisses();
+
+    s_vertexBufferPool.nextFrame();
+    s_indexBufferPool.nextFrame();
+
     if (Configuration::s_enableImgui)
     {
         renderIm3d();
@@ -485,7 +533,7 @@ HRESULT Device::CreateTexture(UINT Width, UINT Height, UINT Levels, DWORD Usage,
         if ((Usage & D3DUSAGE_RENDERTARGET) && (Format == D3DFMT_A8R8G8B8 || Format == D3DFMT_A8B8G8R8))
             Format = D3DFMT_A16B16G16R16F;
 
-        *ppTexture = new Texture(Width, Height, Levels);
+        *ppTexture = new Texture(Width, Height, Levels, Format);
 
         auto& message = s_messageSender.makeMessage<MsgCreateTexture>();
 
@@ -508,30 +556,16 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::CreateCubeTexture, UINT EdgeLength, UI
 
 HRESULT Device::CreateVertexBuffer(UINT Length, DWORD Usage, DWORD FVF, D3DPOOL Pool, VertexBuffer** ppVertexBuffer, HANDLE* pSharedHandle)
 {
-    *ppVertexBuffer = new VertexBuffer(Length);
-
-    auto& message = s_messageSender.makeMessage<MsgCreateVertexBuffer>();
-
-    message.length = Length;
-    message.vertexBufferId = (*ppVertexBuffer)->getId();
-    message.allowUnorderedAccess = false;
-
-    s_messageSender.endMessage();
+    *ppVertexBuffer = new VertexBuffer(Length, (Usage & D3DUSAGE_DYNAMIC) != 0);
+    (*ppVertexBuffer)->create(false);
 
     return S_OK;
 }
 
 HRESULT Device::CreateIndexBuffer(UINT Length, DWORD Usage, D3DFORMAT Format, D3DPOOL Pool, IndexBuffer** ppIndexBuffer, HANDLE* pSharedHandle)
 {
-    *ppIndexBuffer = new IndexBuffer(Length);
-
-    auto& message = s_messageSender.makeMessage<MsgCreateIndexBuffer>();
-
-    message.length = Length;
-    message.format = Format;
-    message.indexBufferId = (*ppIndexBuffer)->getId();
-
-    s_messageSender.endMessage();
+    *ppIndexBuffer = new IndexBuffer(Length, (Usage & D3DUSAGE_DYNAMIC) != 0);
+    (*ppIndexBuffer)->create(Format);
 
     return S_OK;
 }
@@ -700,35 +734,49 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::SetClipPlane, DWORD Index, const float
 
 FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetClipPlane, DWORD Index, float* pPlane)
 
+// Render states that the bridge handles, the rest are only shadowed
+static bool isForwardedRenderState(D3DRENDERSTATETYPE state)
+{
+    switch (state)
+    {
+    case D3DRS_ZENABLE:
+    case D3DRS_FILLMODE:
+    case D3DRS_ZWRITEENABLE:
+    case D3DRS_ALPHATESTENABLE:
+    case D3DRS_SRCBLEND:
+    case D3DRS_DESTBLEND:
+    case D3DRS_CULLMODE:
+    case D3DRS_ZFUNC:
+    case D3DRS_ALPHAREF:
+    case D3DRS_ALPHABLENDENABLE:
+    case D3DRS_COLORWRITEENABLE:
+    case D3DRS_BLENDOP:
+    case D3DRS_SCISSORTESTENABLE:
+    case D3DRS_SLOPESCALEDEPTHBIAS:
+    case D3DRS_COLORWRITEENABLE1:
+    case D3DRS_COLORWRITEENABLE2:
+    case D3DRS_COLORWRITEENABLE3:
+    case D3DRS_DEPTHBIAS:
+    case D3DRS_SRCBLENDALPHA:
+    case D3DRS_DESTBLENDALPHA:
+    case D3DRS_BLENDOPALPHA:
+        return true;
+    }
+
+    return false;
+}
+
 HRESULT Device::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
 {
     assert(State < 210);
 
-    if (m_renderStates[State] != Value)
+    if (m_recordingStateBlock != nullptr)
     {
-        switch (State)
-        {
-        case D3DRS_ZENABLE:
-        case D3DRS_FILLMODE:
-        case D3DRS_ZWRITEENABLE:
-        case D3DRS_ALPHATESTENABLE:
-        case D3DRS_SRCBLEND:
-        case D3DRS_DESTBLEND:
-        case D3DRS_CULLMODE:
-        case D3DRS_ZFUNC:
-        case D3DRS_ALPHAREF:
-        case D3DRS_ALPHABLENDENABLE:
-        case D3DRS_COLORWRITEENABLE:
-        case D3DRS_BLENDOP:
-        case D3DRS_SCISSORTESTENABLE:
-        case D3DRS_SLOPESCALEDEPTHBIAS:
-        case D3DRS_COLORWRITEENABLE1:
-        case D3DRS_COLORWRITEENABLE2:
-        case D3DRS_COLORWRITEENABLE3:
-        case D3DRS_DEPTHBIAS:
-        case D3DRS_SRCBLENDALPHA:
-        case D3DRS_DESTBLENDALPHA:
-        case D3DRS_BLENDOPALPHA:
+        m_recordingStateBlock->setRenderState(State, Value);
+    }
+    else if (m_renderStates[State] != Value)
+    {
+        if (isForwardedRenderState(State))
         {
             auto& message = s_messageSender.makeMessage<MsgSetRenderState>();
 
@@ -736,9 +784,6 @@ HRESULT Device::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
             message.value = Value;
 
             s_messageSender.endMessage();
-
-            break;
-        }
         }
 
         m_renderStates[State] = Value;
@@ -749,11 +794,158 @@ HRESULT Device::SetRenderState(D3DRENDERSTATETYPE State, DWORD Value)
 
 FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetRenderState, D3DRENDERSTATETYPE State, DWORD* pValue)
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::CreateStateBlock, D3DSTATEBLOCKTYPE Type, IDirect3DStateBlock9** ppSB)
+HRESULT Device::CreateStateBlock(D3DSTATEBLOCKTYPE Type, StateBlock** ppSB)
+{
+    const auto stateBlock = new StateBlock(this);
+
+    // Only the states tracked by the device get captured, which are all pixel states
+    // except for the cull mode. Textures are only part of full state blocks.
+    for (uint32_t i = 0; i < _countof(m_renderStates); i++)
+    {
+        const auto state = static_cast<D3DRENDERSTATETYPE>(i);
+
+        if (isForwardedRenderState(state) && (Type == D3DSBT_ALL ||
+            (Type == D3DSBT_VERTEXSTATE) == (state == D3DRS_CULLMODE)))
+        {
+            stateBlock->setRenderState(state, m_renderStates[i]);
+        }
+    }
+
+    if (Type != D3DSBT_VERTEXSTATE)
+    {
+        for (uint32_t i = 0; i < _countof(m_samplerStates); i++)
+        {
+            for (uint32_t j = D3DSAMP_ADDRESSU; j < _countof(m_samplerStates[i]); j++)
+                stateBlock->setSamplerState(i, static_cast<D3DSAMPLERSTATETYPE>(j), m_samplerStates[i][j]);
+        }
+    }
+
+    if (Type == D3DSBT_ALL)
+    {
+        for (uint32_t i = 0; i < _countof(m_textures); i++)
+            stateBlock->setTexture(i, m_textures[i].Get());
+    }
+
+    *ppSB = stateBlock;
+
+    return S_OK;
+}
+
+HRESULT Device::BeginStateBlock()
+{
+    if (m_recordingStateBlock != nullptr)
+        return D3DERR_INVALIDCALL;
+
+    m_recordingStateBlock.Attach(new StateBlock(this));
+
+    return S_OK;
+}
+
+HRESULT Device::EndStateBlock(StateBlock** ppSB)
+{
+    if (m_recordingStateBlock == nullptr)
+        return D3DERR_INVALIDCALL;
+
+    *ppSB = m_recordingStateBlock.Detach();
+
+    return S_OK;
+}
+
+void Device::captureStateBlock(StateBlock& stateBlock) const
+{
+    for (uint32_t i = 0; i < _countof(m_renderStates); i++)
+    {
+        const auto state = static_cast<D3DRENDERSTATETYPE>(i);
+
+        if (stateBlock.hasRenderState(state))
+            stateBlock.setRenderState(state, m_renderStates[i]);
+    }
+
+    for (uint32_t i = 0; i < _countof(m_samplerStates); i++)
+    {
+        for (uint32_t j = 0; j < _countof(m_samplerStates[i]); j++)
+        {
+            const auto type = static_cast<D3DSAMPLERSTATETYPE>(j);
+
+            if (stateBlock.hasSamplerState(i, type))
+                stateBlock.setSamplerState(i, type, m_samplerStates[i][j]);
+        }
+    }
+
+    for (uint32_t i = 0; i < _countof(m_textures); i++)
+    {
+        if (stateBlock.hasTexture(i))
+            stateBlock.setTexture(i, m_textures[i].Get());
+    }
+}
+
+void Device::applyStateBlock(const StateBlock& stateBlock)
+{
+    MsgApplyStateBlock::RenderState renderStates[_countof(m_renderStates)];
+    MsgApplyStateBlock::SamplerState samplerStates[_countof(m_samplerStates) * _countof(m_samplerStates[0])];
+    MsgApplyStateBlock::Texture textures[_countof(m_textures)];
+
+    uint32_t renderStateCount = 0;
+    uint32_t samplerStateCount = 0;
+    uint32_t textureCount = 0;
+
+    for (uint32_t i = 0; i < _countof(m_renderStates); i++)
+    {
+        const auto state = static_cast<D3DRENDERSTATETYPE>(i);
+
+        if (stateBlock.hasRenderState(state) && m_renderStates[i] != stateBlock.getRenderState(state))
+        {
+            m_renderStates[i] = stateBlock.getRenderState(state);
+
+            if (isForwardedRenderState(state))
+                renderStates[renderStateCount++] = { static_cast<uint8_t>(i), m_renderStates[i] };
+        }
+    }
+
+    for (uint32_t i = 0; i < _countof(m_samplerStates); i++)
+    {
+        for (uint32_t j = 0; j < _countof(m_samplerStates[i]); j++)
+        {
+            const auto type = static_cast<D3DSAMPLERSTATETYPE>(j);
+
+            if (stateBlock.hasSamplerState(i, type) && m_samplerStates[i][j] != stateBlock.getSamplerState(i, type))
+            {
+                m_samplerStates[i][j] = stateBlock.getSamplerState(i, type);
+                samplerStates[samplerStateCount++] = { static_cast<uint8_t>(i), static_cast<uint8_t>(j), m_samplerStates[i][j] };
+            }
+        }
+    }
+
+    for (uint32_t i = 0; i < _countof(m_textures); i++)
+    {
+        const auto texture = stateBlock.getTexture(i);
+
+        if (stateBlock.hasTexture(i) && m_textures[i].Get() != texture)
+        {
+            m_textures[i] = texture;
+            textures[textureCount++] = { static_cast<uint8_t>(i), texture != nullptr ? texture->getId() : NULL };
+        }
+    }
+
+    if (renderStateCount == 0 && samplerStateCount == 0 && textureCount == 0)
+        return;
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::BeginStateBlock)
+    const uint32_t renderStatesSize = renderStateCount * sizeof(MsgApplyStateBlock::RenderState);
+    const uint32_t samplerStatesSize = samplerStateCount * sizeof(MsgApplyStateBlock::SamplerState);
+    const uint32_t texturesSize = textureCount * sizeof(MsgApplyStateBlock::Texture);
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::EndStateBlock, IDirect3DStateBlock9** ppSB)
+    auto& message = s_messageSender.makeMessage<MsgApplyStateBlock>(renderStatesSize + samplerStatesSize + texturesSize);
+
+    message.renderStateCount = static_cast<uint8_t>(renderStateCount);
+    message.samplerStateCount = static_cast<uint8_t>(samplerStateCount);
+    message.textureCount = static_cast<uint8_t>(textureCount);
+
+    memcpy(message.data, renderStates, renderStatesSize);
+    memcpy(message.data + renderStatesSize, samplerStates, samplerStatesSize);
+    memcpy(message.data + renderStatesSize + samplerStatesSize, textures, texturesSize);
+
+    s_messageSender.endMessage();
+}
 
 FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::SetClipStatus, const D3DCLIPSTATUS9* pClipStatus)
 
@@ -763,7 +955,11 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetTexture, DWORD Stage, BaseTexture**
 
 HRESULT Device::SetTexture(DWORD Stage, BaseTexture* pTexture)
 {
-    if (m_textures[Stage].Get() != pTexture)
+    if (m_recordingStateBlock != nullptr)
+    {
+        m_recordingStateBlock->setTexture(Stage, pTexture);
+    }
+    else if (m_textures[Stage].Get() != pTexture)
     {
         auto& message = s_messageSender.makeMessage<MsgSetTexture>();
 
@@ -791,7 +987,11 @@ HRESULT Device::SetSamplerState(DWORD Sampler, D3DSAMPLERSTATETYPE Type, DWORD V
 {
     assert(Type < 14);
 
-    if (m_samplerStates[Sampler][Type] != Value)
+    if (m_recordingStateBlock != nullptr)
+    {
+        m_recordingStateBlock->setSamplerState(Sampler, Type, Value);
+    }
+    else if (m_samplerStates[Sampler][Type] != Value)
     {
         auto& message = s_messageSender.makeMessage<MsgSetSamplerState>();
 
@@ -873,6 +1073,8 @@ UINT calculatePrimitiveElements(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCo
 
 HRESULT Device::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex, UINT PrimitiveCount)
 {
+    flushPendingState();
+
     auto& message = s_messageSender.makeMessage<MsgDrawPrimitive>();
 
     message.primitiveType = PrimitiveType;
@@ -884,8 +1086,71 @@ HRESULT Device::DrawPrimitive(D3DPRIMITIVETYPE PrimitiveType, UINT StartVertex,
     return S_OK;
 }
 
+void Device::drawIndexedPrimitives(D3DPRIMITIVETYPE primitiveType, INT baseVertexIndex, UINT startIndex, UINT indexCount)
+{
+    using Draw = MsgDrawIndexedPrimitives::Draw;
+
+    if (m_multiDraw.message != nullptr && m_multiDraw.primitiveType == primitiveType)
+    {
+        // Lists with contiguous index ranges can be merged into the previous draw
+        const bool isContiguous = primitiveType != D3DPT_LINESTRIP &&
+            primitiveType != D3DPT_TRIANGLESTRIP &&
+            primitiveType != D3DPT_TRIANGLEFAN &&
+            m_multiDraw.baseVertexIndex == baseVertexIndex &&
+            m_multiDraw.startIndex + m_multiDraw.indexCount == startIndex;
+
+        const auto end = static_cast<Draw*>(s_messageSender.tryExtendMessage(m_multiDraw.message,
+            m_multiDraw.byteSize, isContiguous ? 0 : sizeof(Draw), m_multiDraw.commitIndex));
+
+        if (end != nullptr)
+        {
+            if (isContiguous)
+            {
+                m_multiDraw.indexCount += indexCount;
+                end[-1].indexCount = m_multiDraw.indexCount;
+            }
+            else
+            {
+                m_multiDraw.baseVertexIndex = baseVertexIndex;
+                m_multiDraw.startIndex = startIndex;
+                m_multiDraw.indexCount = indexCount;
+                end[0] = { baseVertexIndex, startIndex, indexCount };
+
+                m_multiDraw.message->dataSize += sizeof(Draw);
+                m_multiDraw.byteSize += sizeof(Draw);
+            }
+
+            s_messageSender.endMessage();
+            return;
+        }
+    }
+
+    auto& message = s_messageSender.makeMessage<MsgDrawIndexedPrimitives>(sizeof(Draw));
+
+    message.primitiveType = static_cast<uint8_t>(primitiveType);
+    *reinterpret_cast<Draw*>(message.data) = { baseVertexIndex, startIndex, indexCount };
+
+    m_multiDraw.message = &message;
+    m_multiDraw.byteSize = offsetof(MsgDrawIndexedPrimitives, data) + sizeof(Draw);
+    m_multiDraw.commitIndex = s_messageSender.getCommitIndex();
+    m_multiDraw.primitiveType = primitiveType;
+    m_multiDraw.baseVertexIndex = baseVertexIndex;
+    m_multiDraw.startIndex = startIndex;
+    m_multiDraw.indexCount = indexCount;
+
+    s_messageSender.endMessage();
+}
+
 HRESULT Device::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVertexIndex, UINT MinVertexIndex, UINT NumVertices, UINT startIndex, UINT primCount)
 {
+    flushPendingState();
+
+    if (Configuration::s_mergeDrawCalls)
+    {
+        drawIndexedPrimitives(PrimitiveType, BaseVertexIndex, startIndex, calculatePrimitiveElements(PrimitiveType, primCount));
+        return S_OK;
+    }
+
     auto& message = s_messageSender.makeMessage<MsgDrawIndexedPrimitive>();
 
     message.primitiveType = PrimitiveType;
@@ -898,10 +1163,59 @@ HRESULT Device::DrawIndexedPrimitive(D3DPRIMITIVETYPE PrimitiveType, INT BaseVer
     return S_OK;
 }
 
+bool Device::allocateTransient(uint32_t vertexSize, uint32_t vertexStride, uint32_t indexSize, uint32_t& vertexOffset, uint32_t& indexOffset)
+{
+    if (Configuration::s_transientRingSize == 0)
+        return false;
+
+    if (!m_transient.vertexRing.isEnabled())
+    {
+        // Cursors wrap around at 4 GB, the capacity needs to divide it evenly
+        uint32_t capacity = 1;
+        while (capacity < Configuration::s_transientRingSize && capacity < 0x400)
+            capacity <<= 1;
+
+        capacity *= 1024 * 1024;
+
+        CreateVertexBuffer(capacity, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, 0, D3DPOOL_DEFAULT, m_transient.vertexBuffer.GetAddressOf(), nullptr);
+        CreateIndexBuffer(capacity, D3DUSAGE_DYNAMIC | D3DUSAGE_WRITEONLY, D3DFMT_INDEX16, D3DPOOL_DEFAULT, m_transient.indexBuffer.GetAddressOf(), nullptr);
+
+        m_transient.vertexRing.init(capacity);
+        m_transient.indexRing.init(capacity);
+    }
+
+    if (!m_transient.vertexRing.allocate(vertexSize, vertexStride, vertexOffset))
+        return false;
+
+    return indexSize == 0 || m_transient.indexRing.allocate(indexSize, sizeof(uint16_t), indexOffset);
+}
+
+template <typename T>
+static void writeTransient(T* buffer, uint32_t offset, const void* data, uint32_t byteSize)
+{
+    void* dstData = nullptr;
+    buffer->Lock(offset, byteSize, &dstData, D3DLOCK_NOOVERWRITE);
+    memcpy(dstData, data, byteSize);
+    buffer->Unlock();
+}
+
 HRESULT Device::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCount, const void* pVertexStreamZeroData, UINT VertexStreamZeroStride)
 {
+    flushPendingState();
+
     const uint32_t vertexCount = calculatePrimitiveElements(PrimitiveType, PrimitiveCount);
 
+    // Stream zero is left undefined after user pointer draws, so it can point to the transient buffer
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
+    if (allocateTransient(vertexCount * VertexStreamZeroStride, VertexStreamZeroStride, 0, vertexOffset, indexOffset))
+    {
+        writeTransient(m_transient.vertexBuffer.Get(), vertexOffset, pVertexStreamZeroData, vertexCount * VertexStreamZeroStride);
+
+        SetStreamSource(0, m_transient.vertexBuffer.Get(), 0, VertexStreamZeroStride);
+        return DrawPrimitive(PrimitiveType, vertexOffset / VertexStreamZeroStride, PrimitiveCount);
+    }
+
     auto& message = s_messageSender.makeMessage<MsgDrawPrimitiveUP>(vertexCount * VertexStreamZeroStride);
 
     message.primitiveType = PrimitiveType;
@@ -916,11 +1230,28 @@ HRESULT Device::DrawPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT PrimitiveCo
 
 HRESULT Device::DrawIndexedPrimitiveUP(D3DPRIMITIVETYPE PrimitiveType, UINT MinVertexIndex, UINT NumVertices, UINT PrimitiveCount, const void* pIndexData, D3DFORMAT IndexDataFormat, const void* pVertexStreamZeroData, UINT VertexStreamZeroStride)
 {
+    flushPendingState();
+
     const uint32_t indexCount = calculatePrimitiveElements(PrimitiveType, PrimitiveCount);
 
     const uint32_t verticesSize = VertexStreamZeroStride * NumVertices;
     const uint32_t indicesSize = (IndexDataFormat == D3DFMT_INDEX32 ? 4 : 2) * indexCount;
 
+    // The transient index buffer is 16-bit, 32-bit indices get sent inline
+    uint32_t vertexOffset = 0;
+    uint32_t indexOffset = 0;
+    if (IndexDataFormat == D3DFMT_INDEX16 && allocateTransient(verticesSize, VertexStreamZeroStride, indicesSize, vertexOffset, indexOffset))
+    {
+        writeTransient(m_transient.vertexBuffer.Get(), vertexOffset, pVertexStreamZeroData, verticesSize);
+        writeTransient(m_transient.indexBuffer.Get(), indexOffset, pIndexData, indicesSize);
+
+        SetStreamSource(0, m_transient.vertexBuffer.Get(), 0, VertexStreamZeroStride);
+        SetIndices(m_transient.indexBuffer.Get());
+
+        return DrawIndexedPrimitive(PrimitiveType, vertexOffset / VertexStreamZeroStride, MinVertexIndex, NumVertices,
+            indexOffset / sizeof(uint16_t), PrimitiveCount);
+    }
+
     auto& message = s_messageSender.makeMessage<MsgDrawIndexedPrimitiveUP>(verticesSize + indicesSize);
 
     message.primitiveType = static_cast<uint8_t>(PrimitiveType);
@@ -1002,12 +1333,15 @@ HRESULT Device::CreateVertexShader(const DWORD* pFunction, VertexShader** ppShad
     {
         pShader.Attach(new VertexShader());
 
-        auto& message = s_messageSender.makeMessage<MsgCreateVertexShader>(FunctionSize);
+        if (!ShaderCache::createVertexShader(pShader->getId(), pFunction, FunctionSize))
+        {
+            auto& message = s_messageSender.makeMessage<MsgCreateVertexShader>(FunctionSize);
 
-        message.vertexShaderId = pShader->getId();
-        memcpy(message.data, pFunction, FunctionSize);
+            message.vertexShaderId = pShader->getId();
+            memcpy(message.data, pFunction, FunctionSize);
 
-        s_messageSender.endMessage();
+            s_messageSender.endMessage();
+        }
     }
 
     pShader.CopyTo(ppShader);
@@ -1032,13 +1366,7 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetVertexShader, VertexShader** ppShad
 
 HRESULT Device::SetVertexShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetVertexShaderConstantF>(Vector4fCount * sizeof(float[4]));
-
-    message.startRegister = StartRegister;
-    memcpy(message.data, pConstantData, Vector4fCount * sizeof(float[4]));
-
-    s_messageSender.endMessage();
-
+    m_vertexShaderConstantsF.set(StartRegister, reinterpret_cast<const float(*)[4]>(pConstantData), Vector4fCount);
     return S_OK;
 }
 
@@ -1050,13 +1378,7 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetVertexShaderConstantI, UINT StartRe
 
 HRESULT Device::SetVertexShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetVertexShaderConstantB>(BoolCount * sizeof(BOOL));
-
-    message.startRegister = StartRegister;
-    memcpy(message.data, pConstantData, BoolCount * sizeof(BOOL));
-
-    s_messageSender.endMessage();
-
+    m_vertexShaderConstantsB.set(StartRegister, pConstantData, BoolCount);
     return S_OK;
 }
 
@@ -1129,12 +1451,15 @@ HRESULT Device::CreatePixelShader(const DWORD* pFunction, PixelShader** ppShader
     {
         pShader.Attach(new PixelShader());
 
-        auto& message = s_messageSender.makeMessage<MsgCreatePixelShader>(FunctionSize);
+        if (!ShaderCache::createPixelShader(pShader->getId(), pFunction, FunctionSize))
+        {
+            auto& message = s_messageSender.makeMessage<MsgCreatePixelShader>(FunctionSize);
 
-        message.pixelShaderId = pShader->getId();
-        memcpy(message.data, pFunction, FunctionSize);
+            message.pixelShaderId = pShader->getId();
+            memcpy(message.data, pFunction, FunctionSize);
 
-        s_messageSender.endMessage();
+            s_messageSender.endMessage();
+        }
     }
 
     pShader.CopyTo(ppShader);
@@ -1159,13 +1484,7 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetPixelShader, PixelShader** ppShader
 
 HRESULT Device::SetPixelShaderConstantF(UINT StartRegister, const float* pConstantData, UINT Vector4fCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetPixelShaderConstantF>(Vector4fCount * sizeof(float[4]));
-
-    message.startRegister = StartRegister;
-    memcpy(message.data, pConstantData, Vector4fCount * sizeof(float[4]));
-
-    s_messageSender.endMessage();
-
+    m_pixelShaderConstantsF.set(StartRegister, reinterpret_cast<const float(*)[4]>(pConstantData), Vector4fCount);
     return S_OK;
 }
 
@@ -1177,13 +1496,7 @@ FUNCTION_STUB(HRESULT, E_NOTIMPL, Device::GetPixelShaderConstantI, UINT StartReg
 
 HRESULT Device::SetPixelShaderConstantB(UINT StartRegister, const BOOL* pConstantData, UINT BoolCount)
 {
-    auto& message = s_messageSender.makeMessage<MsgSetPixelShaderConstantB>(BoolCount * sizeof(BOOL));
-
-    message.startRegister = StartRegister;
-    memcpy(message.data, pConstantData, BoolCount * sizeof(BOOL));
-
-    s_messageSender.endMessage();
-
+    m_pixelShaderConstantsB.set(StartRegister, pConstantData, BoolCount);
     return S_OK;
 }
 
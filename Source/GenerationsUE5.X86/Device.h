@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ShaderConstantFile.h"
+#include "TransientRing.h"
 #include "Unknown.h"
 
 class BaseTexture;
@@ -7,12 +9,15 @@ class CubeTexture;
 class D3D9;
 class IndexBuffer;
 class PixelShader;
+class StateBlock;
 class Surface;
 class Texture;
 class VertexBuffer;
 class VertexDeclaration;
 class VertexShader;
 
+struct MsgDrawIndexedPrimitives;
+
 class Device : public Unknown
 {
 protected:
@@ -54,6 +59,39 @@ protected:
 
     UINT m_settings[16]{};
 
+    ComPtr<StateBlock> m_recordingStateBlock;
+
+    // Last multi draw message, consecutive draw calls get appended to it
+    // for as long as nothing else gets sent in between.
+    struct
+    {
+        MsgDrawIndexedPrimitives* message;
+        uint32_t byteSize;
+        uint32_t commitIndex;
+        D3DPRIMITIVETYPE primitiveType;
+        int32_t baseVertexIndex;
+        uint32_t startIndex;
+        uint32_t indexCount;
+    } m_multiDraw{};
+
+    void drawIndexedPrimitives(D3DPRIMITIVETYPE primitiveType, INT baseVertexIndex, UINT startIndex, UINT indexCount);
+
+    // Persistent buffers the user pointer draws and ImGui get their vertices and indices from
+    struct
+    {
+        ComPtr<VertexBuffer> vertexBuffer;
+        ComPtr<IndexBuffer> indexBuffer;
+        TransientRing vertexRing;
+        TransientRing indexRing;
+    } m_transient;
+
+    bool allocateTransient(uint32_t vertexSize, uint32_t vertexStride, uint32_t indexSize, uint32_t& vertexOffset, uint32_t& indexOffset);
+
+    ShaderConstantFile<float[4], 256> m_vertexShaderConstantsF;
+    ShaderConstantFile<float[4], 256> m_pixelShaderConstantsF;
+    ShaderConstantFile<BOOL, 16> m_vertexShaderConstantsB;
+    ShaderConstantFile<BOOL, 16> m_pixelShaderConstantsB;
+
     void createVertexDeclaration(const D3DVERTEXELEMENT9* pVertexElements, VertexDeclaration** ppDecl, bool isFVF);
 
     struct
@@ -90,6 +128,13 @@ public:
     Texture* getBackBuffer() const;
     void storeIm3dDepthStencil();
 
+    // Sends the shader constants and combined buffer writes since the last flush.
+    // Called before every draw call, and before anything else that reads them.
+    void flushPendingState();
+
+    void captureStateBlock(StateBlock& stateBlock) const;
+    void applyStateBlock(const StateBlock& stateBlock);
+
     virtual HRESULT TestCooperativeLevel() final;
     virtual UINT GetAvailableTextureMem() final;
     virtual HRESULT EvictManagedResources() final;
@@ -146,9 +191,9 @@ public:
     virtual HRESULT GetClipPlane(DWORD Index, float* pPlane) final;
     virtual HRESULT SetRenderState(D3DRENDERSTATETYPE State, DWORD Value) final;
     virtual HRESULT GetRenderState(D3DRENDERSTATETYPE State, DWORD* pValue) final;
-    virtual HRESULT CreateStateBlock(D3DSTATEBLOCKTYPE Type, IDirect3DStateBlock9** ppSB) final;
+    virtual HRESULT CreateStateBlock(D3DSTATEBLOCKTYPE Type, StateBlock** ppSB) final;
     virtual HRESULT BeginStateBlock() final;
-    virtual HRESULT EndStateBlock(IDirect3DStateBlock9** ppSB) final;
+    virtual HRESULT EndStateBlock(StateBlock** ppSB) final;
     virtual HRESULT SetClipStatus(const D3DCLIPSTATUS9* pClipStatus) final;
     virtual HRESULT GetClipStatus(D3DCLIPSTATUS9* pClipStatus) final;
     virtual HRESULT GetTexture(DWORD Stage, BaseTexture** ppTexture) final;
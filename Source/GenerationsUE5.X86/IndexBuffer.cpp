@@ -2,17 +2,19 @@
 
 #include "FreeListAllocator.h"
 #include "AlignmentUtil.h"
+#include "Configuration.h"
 #include "Message.h"
+#include "MessageCompression.h"
 #include "MessageSender.h"
 
-static FreeListAllocator s_idAllocator;
+// Buffers get created and released from loading threads all the time
+static LockFreeListAllocator<0x100000> s_idAllocator;
 
-IndexBuffer::IndexBuffer(uint32_t byteSize)
+IndexBuffer::IndexBuffer(uint32_t byteSize, bool dynamic)
 {
     m_id = s_idAllocator.allocate();
     m_byteSize = byteSize;
-
-    s_wastedMemory += alignUp(byteSize, 0x10000u) - byteSize;
+    m_dynamic = dynamic;
 }
 
 IndexBuffer::~IndexBuffer()
@@ -26,7 +28,42 @@ IndexBuffer::~IndexBuffer()
 
     s_idAllocator.free(m_id);
 
-    s_wastedMemory -= alignUp(m_byteSize, 0x10000u) - m_byteSize;
+    if (m_pooled)
+        s_indexBufferPool.free(m_poolAllocation, m_byteSize);
+    else
+        s_wastedMemory -= alignUp(m_byteSize, 0x10000u) - m_byteSize;
+}
+
+void IndexBuffer::create(D3DFORMAT format)
+{
+    m_pooled = s_indexBufferPool.shouldUse(m_byteSize);
+
+    if (m_pooled)
+    {
+        m_poolAllocation = s_indexBufferPool.allocate(m_byteSize);
+
+        auto& message = s_messageSender.makeMessage<MsgCreateIndexBufferInHeap>();
+
+        message.length = m_byteSize;
+        message.format = format;
+        message.indexBufferId = m_id;
+        message.heapId = m_poolAllocation.heapId;
+        message.offset = m_poolAllocation.offset;
+
+        s_messageSender.endMessage();
+    }
+    else
+    {
+        auto& message = s_messageSender.makeMessage<MsgCreateIndexBuffer>();
+
+        message.length = m_byteSize;
+        message.format = format;
+        message.indexBufferId = m_id;
+
+        s_messageSender.endMessage();
+
+        s_wastedMemory += alignUp(m_byteSize, 0x10000u) - m_byteSize;
+    }
 }
 
 uint32_t IndexBuffer::getId() const
@@ -39,11 +76,80 @@ uint32_t IndexBuffer::getByteSize() const
     return m_byteSize;
 }
 
+static void writeCombined(uint32_t id, uint32_t offset, const uint8_t* data, uint32_t byteSize)
+{
+    PayloadAllocation payload{};
+    if (s_payloadHeap.shouldUse(byteSize) && s_payloadHeap.allocate(byteSize, payload))
+    {
+        memcpy(payload.data, data, byteSize);
+
+        auto& message = s_messageSender.makeMessage<MsgWriteIndexBufferFromHeap>();
+
+        message.indexBufferId = id;
+        message.offset = offset;
+        message.initialWrite = false;
+        message.payloadOffset = payload.offset;
+        message.payloadSize = payload.byteSize;
+
+        s_payloadHeap.fence(payload);
+    }
+    else
+    {
+        auto& message = s_messageSender.makeMessage<MsgWriteIndexBuffer>(byteSize);
+
+        message.indexBufferId = id;
+        message.offset = offset;
+        message.initialWrite = false;
+        memcpy(message.data, data, byteSize);
+    }
+
+    s_messageSender.endMessage();
+}
+
 HRESULT IndexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DWORD Flags)
 {
     if (SizeToLock == 0)
         SizeToLock = m_byteSize - OffsetToLock;
 
+    // Only initial writes get compressed, dynamic buffers rewritten every frame aren't worth the time
+    if (Configuration::s_compressIndexBuffers && m_pendingWrite && SizeToLock >= Configuration::s_compressionThreshold)
+    {
+        // The message gets made on unlock, once the compressed size is known
+        m_compressionData = std::make_unique<uint8_t[]>(SizeToLock);
+        m_compressionOffsetToLock = OffsetToLock;
+        m_compressionSizeToLock = SizeToLock;
+        *ppbData = m_compressionData.get();
+
+        m_pendingWrite = false;
+
+        return S_OK;
+    }
+
+    // Buffers locked again after their initial write are likely rewritten every frame,
+    // their writes get merged until the next draw call reads them. Dynamic buffers
+    // include the transient rings, a staging copy of those would double their size.
+    if (Configuration::s_writeCombineBuffers && !m_pendingWrite && !m_dynamic)
+    {
+        if (m_writeCombiner == nullptr)
+            m_writeCombiner = std::make_unique<WriteCombiner>(m_id, m_byteSize, writeCombined);
+
+        *ppbData = m_writeCombiner->lock(OffsetToLock, SizeToLock);
+
+        return S_OK;
+    }
+
+    if (s_payloadHeap.shouldUse(SizeToLock) && s_payloadHeap.allocate(SizeToLock, m_payload))
+    {
+        // The message gets made on unlock, after the data is written
+        m_payloadOffsetToLock = OffsetToLock;
+        m_payloadInitialWrite = m_pendingWrite;
+        *ppbData = m_payload.data;
+
+        m_pendingWrite = false;
+
+        return S_OK;
+    }
+
     auto& message = s_messageSender.makeMessage<MsgWriteIndexBuffer>(SizeToLock);
 
     message.indexBufferId = m_id;
@@ -58,6 +164,71 @@ HRESULT IndexBuffer::Lock(UINT OffsetToLock, UINT SizeToLock, void** ppbData, DW
 
 HRESULT IndexBuffer::Unlock()
 {
+    if (m_writeCombiner != nullptr)
+    {
+        m_writeCombiner->unlock();
+        return S_OK;
+    }
+
+    if (m_compressionData != nullptr)
+    {
+        uint32_t compressedSize = 0;
+        const uint8_t* compressedData = MessageCompression::compress(
+            m_compressionData.get(), m_compressionSizeToLock, compressedSize);
+
+        PayloadAllocation payload{};
+        if (compressedData != nullptr && MessageSender::canMakeMessage<MsgWriteIndexBufferCompressed>(compressedSize))
+        {
+            auto& message = s_messageSender.makeMessage<MsgWriteIndexBufferCompressed>(compressedSize);
+
+            message.indexBufferId = m_id;
+            message.offset = m_compressionOffsetToLock;
+            message.initialWrite = true;
+            message.uncompressedSize = m_compressionSizeToLock;
+            message.dataSize = compressedSize;
+            memcpy(message.data, compressedData, compressedSize);
+        }
+        else if (s_payloadHeap.shouldUse(m_compressionSizeToLock) && s_payloadHeap.allocate(m_compressionSizeToLock, payload))
+        {
+            memcpy(payload.data, m_compressionData.get(), m_compressionSizeToLock);
+
+            auto& message = s_messageSender.makeMessage<MsgWriteIndexBufferFromHeap>();
+
+            message.indexBufferId = m_id;
+            message.offset = m_compressionOffsetToLock;
+            message.initialWrite = true;
+            message.payloadOffset = payload.offset;
+            message.payloadSize = payload.byteSize;
+
+            s_payloadHeap.fence(payload);
+        }
+        else
+        {
+            // Inline only as a last resort, large writes would take up most of a batch
+            auto& message = s_messageSender.makeMessage<MsgWriteIndexBuffer>(m_compressionSizeToLock);
+
+            message.indexBufferId = m_id;
+            message.offset = m_compressionOffsetToLock;
+            message.initialWrite = true;
+            memcpy(message.data, m_compressionData.get(), m_compressionSizeToLock);
+        }
+
+        m_compressionData = nullptr;
+    }
+    else if (m_payload.data != nullptr)
+    {
+        auto& message = s_messageSender.makeMessage<MsgWriteIndexBufferFromHeap>();
+
+        message.indexBufferId = m_id;
+        message.offset = m_payloadOffsetToLock;
+        message.initialWrite = m_payloadInitialWrite;
+        message.payloadOffset = m_payload.offset;
+        message.payloadSize = m_payload.byteSize;
+
+        s_payloadHeap.fence(m_payload);
+        m_payload = {};
+    }
+
     s_messageSender.endMessage();
 
     return S_OK;
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "BufferPool.h"
+#include "PayloadHeap.h"
 #include "Resource.h"
+#include "WriteCombiner.h"
 
 class IndexBuffer : public Resource
 {
@@ -9,13 +12,31 @@ protected:
     uint32_t m_id;
     uint32_t m_byteSize;
     bool m_pendingWrite = true;
+    bool m_dynamic;
+
+    bool m_pooled = false;
+    BufferPoolAllocation m_poolAllocation{};
+
+    PayloadAllocation m_payload{};
+    uint32_t m_payloadOffsetToLock{};
+    bool m_payloadInitialWrite{};
+
+    std::unique_ptr<uint8_t[]> m_compressionData;
+    uint32_t m_compressionOffsetToLock{};
+    uint32_t m_compressionSizeToLock{};
+
+    std::unique_ptr<WriteCombiner> m_writeCombiner;
 
 public:
     static inline alignas(0x4) std::atomic<uint32_t> s_wastedMemory;
 
-    explicit IndexBuffer(uint32_t byteSize);
+    // Dynamic buffers are rewritten through discarding locks, they skip write combining
+    explicit IndexBuffer(uint32_t byteSize, bool dynamic = false);
     ~IndexBuffer() override;
 
+    // Creates the buffer on the bridge, small buffers get suballocated from a pool
+    void create(D3DFORMAT format);
+
     uint32_t getId() const;
     uint32_t getByteSize() const;
 
@@ -0,0 +1,29 @@
+#include "MessageCompression.h"
+
+#include "Configuration.h"
+
+static thread_local std::vector<uint8_t> s_scratch;
+
+const uint8_t* MessageCompression::compress(const void* data, uint32_t byteSize, uint32_t& compressedSize)
+{
+    if (byteSize < Configuration::s_compressionThreshold || byteSize > LZ4_MAX_INPUT_SIZE)
+        return nullptr;
+
+    // Anything that doesn't save at least 1/8 of the size isn't worth decompressing
+    const uint32_t maxCompressedSize = byteSize - byteSize / 8;
+
+    if (s_scratch.size() < maxCompressedSize)
+        s_scratch.resize(maxCompressedSize);
+
+    const int result = LZ4_compress_default(
+        static_cast<const char*>(data),
+        reinterpret_cast<char*>(s_scratch.data()),
+        static_cast<int>(byteSize),
+        static_cast<int>(maxCompressedSize));
+
+    if (result <= 0)
+        return nullptr;
+
+    compressedSize = static_cast<uint32_t>(result);
+    return s_scratch.data();
+}
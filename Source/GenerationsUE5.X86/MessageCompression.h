@@ -0,0 +1,13 @@
+#pragma once
+
+// LZ4 block compression for bulk payloads. The bridge decompresses them
+// straight into the upload buffer, trading CPU time on both ends for less
+// memory traffic through the mapping.
+class MessageCompression
+{
+public:
+    // Returns nullptr if the payload is below the configured threshold or
+    // doesn't compress well enough to be worth it. The returned pointer is
+    // thread local and stays valid until the next call on the same thread.
+    static const uint8_t* compress(const void* data, uint32_t byteSize, uint32_t& compressedSize);
+};
@@ -1,63 +1,187 @@
 #include "MessageSender.h"
 
+#include "Configuration.h"
 #include "LockGuard.h"
+#include "Logger.h"
 #include "Message.h"
+#include "MessageInfo.h"
+#include "MessageTelemetry.h"
+#include "MessageTrace.h"
+#include "PayloadHeap.h"
+
+// Leaves room for the payload fence at the end of every batch
+static constexpr uint32_t s_reservedSize = sizeof(MsgPayloadFence);
 
 bool MessageSender::canMakeMessage(uint32_t byteSize, uint32_t alignment)
 {
-    return ((sizeof(uint32_t) + alignment - 1) & ~(alignment - 1)) + byteSize <= MemoryMappedFile::s_size;
+    return ((sizeof(uint32_t) + alignment - 1) & ~(alignment - 1)) + byteSize <= MemoryMappedFile::s_size - s_reservedSize;
 }
 
-MessageSender::MessageSender() : m_pendingMessages(0)
+MessageSender::MessageSender()
+    : m_offset(sizeof(uint32_t))
+    , m_pendingMessages(0)
+    , m_committing(false)
+    , m_submittedBuffers(0)
+    , m_completedBuffers(0)
+    , m_stopCommitThread(false)
+    , m_pipelineLatency(0.0)
 {
-    m_messages = static_cast<uint8_t*>(_aligned_malloc(MemoryMappedFile::s_size, 0x10));
-    m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile.map());
 }
 
 MessageSender::~MessageSender()
 {
-    m_memoryMappedFile.unmap(m_memoryMap);
-    _aligned_free(m_messages);
+    if (m_captureFile != nullptr)
+        fclose(m_captureFile);
+
+    if (m_messageRing != nullptr)
+    {
+        m_memoryMappedFile->unmap(m_messageRing);
+    }
+    else if (m_memoryMap != nullptr)
+    {
+        if (m_commitThread.joinable())
+        {
+            m_stopCommitThread.store(true);
+            m_submitEvent.set();
+            m_commitThread.join();
+        }
+
+        m_memoryMappedFile->unmap(m_memoryMap);
+
+        for (uint32_t i = 0; i < m_bufferCount; i++)
+            _aligned_free(m_buffers[i]);
+    }
 }
 
-void* MessageSender::makeMessage(uint32_t byteSize, uint32_t alignment)
+void MessageSender::init()
 {
-    assert(byteSize <= MemoryMappedFile::s_size);
+    if (Configuration::s_zeroCopyTransport)
+    {
+        const uint32_t slotCount = std::clamp(Configuration::s_messageRingSlotCount,
+            MessageRingHeader::s_minSlotCount, MessageRingHeader::s_maxSlotCount);
 
-    LockGuard lock(m_mutex);
+        m_memoryMappedFile.emplace(MessageRingHeader::s_name,
+            MessageRingHeader::getMappingSize(slotCount, MemoryMappedFile::s_size));
 
-    uint32_t alignedOffset = m_offset;
+        m_messageRing = static_cast<MessageRingHeader*>(m_memoryMappedFile->map());
+        m_messageRing->slotCount = slotCount;
+        m_messageRing->slotSize = MemoryMappedFile::s_size;
+        m_messageRing->producerCursor.store(0);
+        m_messageRing->consumerCursor.store(0);
 
-    if ((alignedOffset & (alignment - 1)) != 0)
-    {
-        alignedOffset += offsetof(MsgPadding, data);
-        alignedOffset += alignment - 1;
-        alignedOffset &= ~(alignment - 1);
+        m_messages = m_messageRing->getSlot(0);
     }
-    if (alignedOffset + byteSize > (MemoryMappedFile::s_size - sizeof(uint32_t)))
+    else
     {
-        commitMessages();
-        alignedOffset = std::max(sizeof(uint32_t), alignment);
+        m_memoryMappedFile.emplace();
+        m_memoryMap = static_cast<uint8_t*>(m_memoryMappedFile->map());
+
+        if (Configuration::s_commitThreadDepth != 0)
+            m_bufferCount = std::min(Configuration::s_commitThreadDepth, s_maxCommitThreadDepth) + 1;
+
+        for (uint32_t i = 0; i < m_bufferCount; i++)
+            m_buffers[i] = static_cast<uint8_t*>(_aligned_malloc(MemoryMappedFile::s_size, 0x10));
+
+        m_messages = m_buffers[0];
+
+        if (m_bufferCount > 1)
+            m_commitThread = std::thread(&MessageSender::commitThreadFunc, this);
     }
 
-    if (m_offset != alignedOffset)
+    if (!Configuration::s_messageCaptureFilePath.empty())
     {
-        const auto padding = reinterpret_cast<MsgPadding*>(&m_messages[m_offset]);
-        padding->id = MsgPadding::s_id;
-        padding->dataSize = alignedOffset - (m_offset + offsetof(MsgPadding, data));
+        m_captureFile = fopen(Configuration::s_messageCaptureFilePath.c_str(), "wb");
 
+        if (m_captureFile != nullptr)
+        {
+            MessageTraceHeader header{};
+            header.magic = MessageTraceHeader::s_magic;
+            header.version = MessageTraceHeader::s_version;
+            header.messageCount = static_cast<uint32_t>(std::size(s_messageInfos));
 #ifdef _DEBUG
-        memset(padding->data, 0xCC, padding->dataSize);
+            header.debugLayout = 1;
 #endif
+            fwrite(&header, sizeof(header), 1, m_captureFile);
+        }
+        else
+        {
+            Logger::logFormatted(LogType::Error, "Unable to open \"%s\" for message capture", Configuration::s_messageCaptureFilePath.c_str());
+        }
+    }
+}
+
+static void backoff(uint32_t& spinCount)
+{
+    if (spinCount < 64)
+        YieldProcessor();
+    else
+        SwitchToThread();
+
+    ++spinCount;
+}
+
+static uint32_t alignOffset(uint32_t offset, uint32_t alignment)
+{
+    if ((offset & (alignment - 1)) != 0)
+    {
+        offset += offsetof(MsgPadding, data);
+        offset += alignment - 1;
+        offset &= ~(alignment - 1);
     }
+    return offset;
+}
+
+void* MessageSender::makeMessage(uint32_t byteSize, uint32_t alignment)
+{
+    assert(byteSize <= MemoryMappedFile::s_size);
+
+    while (true)
+    {
+        // Announce the reservation before checking for a commit, so that
+        // either the commit waits for us or we see the commit and back off.
+        ++m_pendingMessages;
+
+        if (!m_committing.load())
+        {
+            uint32_t offset = m_offset.load(std::memory_order_relaxed);
+
+            while (true)
+            {
+                const uint32_t alignedOffset = alignOffset(offset, alignment);
+                if (alignedOffset + byteSize > (MemoryMappedFile::s_size - s_reservedSize))
+                    break;
+
+                if (m_offset.compare_exchange_weak(offset, alignedOffset + byteSize, std::memory_order_relaxed))
+                {
+                    if (offset != alignedOffset)
+                    {
+                        const auto padding = reinterpret_cast<MsgPadding*>(&m_messages[offset]);
+                        padding->id = MsgPadding::s_id;
+                        padding->dataSize = alignedOffset - (offset + offsetof(MsgPadding, data));
 
-    void* message = &m_messages[alignedOffset];
 #ifdef _DEBUG
-    memset(message, 0xCC, byteSize);
+                        memset(padding->data, 0xCC, padding->dataSize);
 #endif
-    m_offset = alignedOffset + byteSize;
-    ++m_pendingMessages;
-    return message;
+                    }
+
+                    void* message = &m_messages[alignedOffset];
+#ifdef _DEBUG
+                    memset(message, 0xCC, byteSize);
+#endif
+                    return message;
+                }
+            }
+        }
+
+        --m_pendingMessages;
+
+        // Either a commit is in progress, in which case this blocks until it's done,
+        // or the buffer is full and we need to commit it ourselves.
+        LockGuard lock(m_mutex);
+
+        if (alignOffset(m_offset.load(std::memory_order_relaxed), alignment) + byteSize > (MemoryMappedFile::s_size - s_reservedSize))
+            commitMessages();
+    }
 }
 
 void MessageSender::endMessage()
@@ -65,6 +189,26 @@ void MessageSender::endMessage()
     --m_pendingMessages;
 }
 
+void* MessageSender::tryExtendMessage(void* message, uint32_t byteSize, uint32_t extraSize, uint32_t commitIndex)
+{
+    ++m_pendingMessages;
+
+    // The commit index can't change while we're pending, so the message is known to be in the current buffer
+    if (!m_committing.load() && m_commitIndex.load() == commitIndex)
+    {
+        uint32_t offset = static_cast<uint32_t>(static_cast<uint8_t*>(message) + byteSize - m_messages);
+
+        if (offset + extraSize <= (MemoryMappedFile::s_size - s_reservedSize) &&
+            m_offset.compare_exchange_strong(offset, offset + extraSize, std::memory_order_relaxed))
+        {
+            return static_cast<uint8_t*>(message) + byteSize;
+        }
+    }
+
+    --m_pendingMessages;
+    return nullptr;
+}
+
 static double computeDuration(const std::chrono::high_resolution_clock::time_point& time)
 {
     return std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(
@@ -75,14 +219,84 @@ void MessageSender::commitMessages()
 {
     LockGuard lock(m_mutex);
 
-    while (m_pendingMessages)
-        ;
+    m_committing.store(true);
 
-    *reinterpret_cast<uint32_t*>(m_messages) = m_offset;
+    // Wait for in-flight messages to be finished
+    uint32_t spinCount = 0;
+    while (m_pendingMessages.load() != 0)
+        backoff(spinCount);
+
+    uint32_t offset = m_offset.load(std::memory_order_relaxed);
+
+    if (s_payloadHeap.isEnabled())
+    {
+        // Lets the bridge report the batch as consumed, so the payload heap can reclaim it
+        const auto fence = reinterpret_cast<MsgPayloadFence*>(&m_messages[offset]);
+        fence->id = MsgPayloadFence::s_id;
+        fence->batchIndex = m_commitIndex;
+        offset += sizeof(MsgPayloadFence);
+    }
+
+    *reinterpret_cast<uint32_t*>(m_messages) = offset;
 
     m_x86Duration = computeDuration(m_time);
 
-    if (!(*s_shouldExit))
+    if (MessageTelemetry::s_enable)
+        MessageTelemetry::record(m_messages, offset);
+
+    if (m_captureFile != nullptr)
+    {
+        const MessageTraceFrame frame{ m_commitIndex, offset };
+        fwrite(&frame, sizeof(frame), 1, m_captureFile);
+        fwrite(m_messages, 1, offset, m_captureFile);
+    }
+
+    if (m_messageRing != nullptr)
+    {
+        if (!(*s_shouldExit))
+        {
+            // Publish the slot in place, the bridge reads it directly from the mapping
+            const uint32_t cursor = m_messageRing->producerCursor.load(std::memory_order_relaxed) + 1;
+            m_messageRing->producerCursor.store(cursor, std::memory_order_release);
+            m_cpuEvent.set();
+
+            // Wait only if every slot is still owned by the bridge
+            while (cursor - m_messageRing->consumerCursor.load(std::memory_order_acquire) >= m_messageRing->slotCount && !(*s_shouldExit))
+            {
+                m_gpuEvent.wait();
+                m_gpuEvent.reset();
+            }
+
+            m_x64Duration = computeDuration(m_time);
+            m_time = std::chrono::high_resolution_clock::now();
+
+            m_messages = m_messageRing->getSlot(cursor);
+        }
+    }
+    else if (m_bufferCount > 1)
+    {
+        if (!(*s_shouldExit))
+        {
+            // Hand the buffer to the commit thread
+            const uint32_t submitted = m_submittedBuffers.load(std::memory_order_relaxed);
+            m_submitTimes[submitted % m_bufferCount] = std::chrono::high_resolution_clock::now();
+            m_submittedBuffers.store(submitted + 1, std::memory_order_release);
+            m_submitEvent.set();
+
+            // Wait only if every buffer is still in flight
+            while (submitted + 1 - m_completedBuffers.load(std::memory_order_acquire) >= m_bufferCount && !(*s_shouldExit))
+            {
+                m_completeEvent.wait();
+                m_completeEvent.reset();
+            }
+
+            m_x64Duration = computeDuration(m_time);
+            m_time = std::chrono::high_resolution_clock::now();
+
+            m_messages = m_buffers[(submitted + 1) % m_bufferCount];
+        }
+    }
+    else if (!(*s_shouldExit))
     {
         // Wait for bridge to copy messages
         m_gpuEvent.wait();
@@ -92,14 +306,53 @@ void MessageSender::commitMessages()
 
         m_gpuEvent.reset();
 
-        memcpy(m_memoryMap, m_messages, m_offset);
+        memcpy(m_memoryMap, m_messages, offset);
 
         // Let bridge know we copied messages
         m_cpuEvent.set();
     }
 
-    m_lastCommittedSize = m_offset;
-    m_offset = sizeof(uint32_t);
+    m_lastCommittedSize = offset;
+    ++m_commitIndex;
+    m_offset.store(sizeof(uint32_t), std::memory_order_relaxed);
+    m_committing.store(false);
+}
+
+void MessageSender::commitThreadFunc()
+{
+    uint32_t completed = 0;
+
+    while (true)
+    {
+        while (m_submittedBuffers.load(std::memory_order_acquire) == completed && !m_stopCommitThread.load())
+        {
+            m_submitEvent.wait();
+            m_submitEvent.reset();
+        }
+
+        if (m_submittedBuffers.load(std::memory_order_acquire) == completed)
+            break;
+
+        const uint32_t index = completed % m_bufferCount;
+
+        if (!(*s_shouldExit))
+        {
+            // Wait for bridge to copy messages
+            m_gpuEvent.wait();
+            m_gpuEvent.reset();
+
+            memcpy(m_memoryMap, m_buffers[index], *reinterpret_cast<const uint32_t*>(m_buffers[index]));
+
+            // Let bridge know we copied messages
+            m_cpuEvent.set();
+
+            m_pipelineLatency.store(computeDuration(m_submitTimes[index]), std::memory_order_relaxed);
+        }
+
+        ++completed;
+        m_completedBuffers.store(completed, std::memory_order_release);
+        m_completeEvent.set();
+    }
 }
 
 void MessageSender::notifyShouldExit() const
@@ -123,3 +376,18 @@ uint32_t MessageSender::getLastCommittedSize() const
     return m_lastCommittedSize;
 }
 
+uint32_t MessageSender::getCommitIndex() const
+{
+    return m_commitIndex;
+}
+
+
+bool MessageSender::isCommitPipelined() const
+{
+    return m_bufferCount > 1;
+}
+
+double MessageSender::getPipelineLatency() const
+{
+    return m_pipelineLatency.load(std::memory_order_relaxed);
+}
@@ -2,9 +2,18 @@
 
 #include "Event.h"
 #include "MemoryMappedFile.h"
+#include "MessageRing.h"
 #include "Mutex.h"
 
+#include <optional>
+
+#ifdef _WIN32
 static size_t* s_shouldExit = reinterpret_cast<size_t*>(0x1E5E2E8);
+#else
+// Tools drive the sender outside of the game, which never asks to exit
+inline size_t s_shouldExitStandIn = 0;
+inline size_t* s_shouldExit = &s_shouldExitStandIn;
+#endif
 
 class MessageSender
 {
@@ -13,15 +22,37 @@ protected:
     Event m_gpuEvent{ Event::s_gpuEventName, TRUE };
     Mutex m_mutex;
     uint8_t* m_messages = nullptr;
-    uint32_t m_offset = sizeof(uint32_t);
+    std::atomic<uint32_t> m_offset;
     std::atomic<uint32_t> m_pendingMessages;
-    MemoryMappedFile m_memoryMappedFile;
-    uint8_t* m_memoryMap;
+    std::atomic<bool> m_committing;
+    std::optional<MemoryMappedFile> m_memoryMappedFile;
+    uint8_t* m_memoryMap = nullptr;
+    MessageRingHeader* m_messageRing = nullptr;
+
+    // Pipelined commit, the commit thread owns the bridge
+    // handshake while the game thread fills the next buffer.
+    static constexpr uint32_t s_maxCommitThreadDepth = 3;
+
+    uint8_t* m_buffers[s_maxCommitThreadDepth + 1]{};
+    std::chrono::high_resolution_clock::time_point m_submitTimes[s_maxCommitThreadDepth + 1];
+    uint32_t m_bufferCount = 1;
+    std::atomic<uint32_t> m_submittedBuffers;
+    std::atomic<uint32_t> m_completedBuffers;
+    Event m_submitEvent{ nullptr, FALSE };
+    Event m_completeEvent{ nullptr, FALSE };
+    std::atomic<bool> m_stopCommitThread;
+    std::thread m_commitThread;
+    std::atomic<double> m_pipelineLatency;
 
     std::chrono::high_resolution_clock::time_point m_time;
     double m_x86Duration{};
     double m_x64Duration{};
     uint32_t m_lastCommittedSize{};
+    std::atomic<uint32_t> m_commitIndex{};
+
+    FILE* m_captureFile = nullptr;
+
+    void commitThreadFunc();
 
 public:
     static bool canMakeMessage(uint32_t byteSize, uint32_t alignment);
@@ -32,9 +63,15 @@ public:
     MessageSender();
     ~MessageSender();
 
+    void init();
+
     void* makeMessage(uint32_t byteSize, uint32_t alignment);
     void endMessage();
 
+    // Grows a message made during the given commit, as long as nothing was made after it.
+    // Returns a pointer to the end of the message, which needs to be followed by endMessage.
+    void* tryExtendMessage(void* message, uint32_t byteSize, uint32_t extraSize, uint32_t commitIndex);
+
     template<typename T>
     T& makeMessage();
 
@@ -48,6 +85,9 @@ public:
     double getX86Duration() const;
     double getX64Duration() const;
     uint32_t getLastCommittedSize() const;
+    uint32_t getCommitIndex() const;
+    bool isCommitPipelined() const;
+    double getPipelineLatency() const;
 };
 
 inline MessageSender s_messageSender;
@@ -0,0 +1,199 @@
+#include "MessageTelemetry.h"
+
+#include "LockGuard.h"
+#include "Logger.h"
+#include "MessageInfo.h"
+#include "Mutex.h"
+
+static constexpr size_t s_messageNum = std::size(s_messageInfos);
+static constexpr size_t s_frameNum = 240;
+
+struct MessageCounter
+{
+    uint32_t count;
+    uint32_t byteSize;
+};
+
+struct FrameTelemetry
+{
+    uint32_t frameIndex;
+    uint32_t commitCount;
+    uint32_t byteSize;
+    MessageCounter counters[s_messageNum];
+};
+
+static Mutex s_mutex;
+static FrameTelemetry s_currentFrame;
+static FrameTelemetry s_frames[s_frameNum];
+static size_t s_frameCount;
+static uint32_t s_frameIndex;
+
+void MessageTelemetry::record(const uint8_t* messages, uint32_t byteSize)
+{
+    LockGuard lock(s_mutex);
+
+    auto& frame = s_currentFrame;
+    ++frame.commitCount;
+    frame.byteSize += byteSize;
+
+    uint32_t offset = sizeof(uint32_t);
+    while (offset < byteSize)
+    {
+        const uint8_t id = messages[offset];
+        assert(id < s_messageNum);
+
+        if (id >= s_messageNum)
+            break;
+
+        const uint32_t messageSize = s_messageInfos[id].getByteSize(messages + offset);
+        ++frame.counters[id].count;
+        frame.counters[id].byteSize += messageSize;
+
+        offset += messageSize;
+    }
+
+}
+
+void MessageTelemetry::endFrame()
+{
+    LockGuard lock(s_mutex);
+
+    // Frames that were committed while recording was off are skipped
+    if (s_currentFrame.commitCount != 0)
+    {
+        s_currentFrame.frameIndex = s_frameIndex;
+        s_frames[s_frameCount % s_frameNum] = s_currentFrame;
+        memset(&s_currentFrame, 0, sizeof(s_currentFrame));
+
+        ++s_frameCount;
+    }
+
+    ++s_frameIndex;
+}
+
+bool MessageTelemetry::exportCsv(const char* filePath)
+{
+    FILE* file = fopen(filePath, "w");
+    if (file == nullptr)
+        return false;
+
+    fprintf(file, "Frame,Commits,Bytes");
+    for (const auto& info : s_messageInfos)
+        fprintf(file, ",%s Count,%s Bytes", info.name, info.name);
+
+    fprintf(file, "\n");
+
+    LockGuard lock(s_mutex);
+
+    const size_t frameNum = std::min(s_frameCount, s_frameNum);
+    for (size_t i = 0; i < frameNum; i++)
+    {
+        const auto& frame = s_frames[(s_frameCount - frameNum + i) % s_frameNum];
+
+        fprintf(file, "%u,%u,%u", frame.frameIndex, frame.commitCount, frame.byteSize);
+        for (const auto& counter : frame.counters)
+            fprintf(file, ",%u,%u", counter.count, counter.byteSize);
+
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    return true;
+}
+
+void MessageTelemetry::renderImgui()
+{
+    ImGui::Checkbox("Record", &s_enable);
+    ImGui::SameLine();
+
+    if (ImGui::Button("Export CSV"))
+    {
+        if (exportCsv("MessageTelemetry.csv"))
+            Logger::log(LogType::Success, "Exported message telemetry to MessageTelemetry.csv");
+        else
+            Logger::log(LogType::Error, "Unable to export message telemetry");
+    }
+
+    LockGuard lock(s_mutex);
+
+    const size_t frameNum = std::min(s_frameCount, s_frameNum);
+    if (frameNum == 0)
+        return;
+
+    uint64_t totalCounts[s_messageNum]{};
+    uint64_t totalByteSizes[s_messageNum]{};
+    uint64_t totalByteSize = 0;
+
+    for (size_t i = 0; i < frameNum; i++)
+    {
+        const auto& frame = s_frames[i];
+        totalByteSize += frame.byteSize;
+
+        for (size_t j = 0; j < s_messageNum; j++)
+        {
+            totalCounts[j] += frame.counters[j].count;
+            totalByteSizes[j] += frame.counters[j].byteSize;
+        }
+    }
+
+    const size_t lastIndex = (s_frameCount - 1) % s_frameNum;
+
+    if (ImPlot::BeginPlot("Bytes Per Frame"))
+    {
+        ImPlot::SetupAxis(ImAxis_Y1, "MB", ImPlotAxisFlags_AutoFit);
+
+        double values[s_frameNum];
+        const int offset = static_cast<int>(s_frameCount % s_frameNum);
+
+        for (size_t i = 0; i < s_messageNum; i++)
+        {
+            if (totalByteSizes[i] == 0)
+                continue;
+
+            for (size_t j = 0; j < s_frameNum; j++)
+                values[j] = static_cast<double>(s_frames[j].counters[i].byteSize) / (1024.0 * 1024.0);
+
+            ImPlot::PlotLine<double>(s_messageInfos[i].name, values, static_cast<int>(frameNum), 1.0, 0.0, ImPlotLineFlags_None,
+                frameNum == s_frameNum ? offset : 0);
+        }
+
+        ImPlot::EndPlot();
+    }
+
+    ImGui::Text("Average Frame Size: %g MB", static_cast<double>(totalByteSize) / (1024.0 * 1024.0 * frameNum));
+    ImGui::Text("Last Frame Size: %g MB", static_cast<double>(s_frames[lastIndex].byteSize) / (1024.0 * 1024.0));
+    ImGui::Text("Last Frame Commits: %u", s_frames[lastIndex].commitCount);
+    ImGui::Text("Last Frame Padding: %g KB", static_cast<double>(s_frames[lastIndex].counters[MsgPadding::s_id].byteSize) / 1024.0);
+
+    if (ImGui::BeginTable("Messages", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY))
+    {
+        ImGui::TableSetupColumn("Message");
+        ImGui::TableSetupColumn("Last Count");
+        ImGui::TableSetupColumn("Last KB");
+        ImGui::TableSetupColumn("Avg Count");
+        ImGui::TableSetupColumn("Avg KB");
+        ImGui::TableHeadersRow();
+
+        for (size_t i = 0; i < s_messageNum; i++)
+        {
+            if (totalCounts[i] == 0)
+                continue;
+
+            const auto& counter = s_frames[lastIndex].counters[i];
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::TextUnformatted(s_messageInfos[i].name);
+            ImGui::TableNextColumn();
+            ImGui::Text("%u", counter.count);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<double>(counter.byteSize) / 1024.0);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<double>(totalCounts[i]) / frameNum);
+            ImGui::TableNextColumn();
+            ImGui::Text("%.1f", static_cast<double>(totalByteSizes[i]) / (1024.0 * frameNum));
+        }
+
+        ImGui::EndTable();
+    }
+}
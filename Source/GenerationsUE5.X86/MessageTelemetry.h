@@ -0,0 +1,18 @@
+#pragma once
+
+class MessageTelemetry
+{
+public:
+    static inline bool s_enable;
+
+    // Adds a committed batch to the current frame, frames that fill up
+    // the message buffer get committed more than once.
+    static void record(const uint8_t* messages, uint32_t byteSize);
+
+    // Called once per frame after its last commit
+    static void endFrame();
+
+    static bool exportCsv(const char* filePath);
+
+    static void renderImgui();
+};
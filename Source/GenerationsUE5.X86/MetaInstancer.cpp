@@ -49,12 +49,7 @@ void MetaInstancer::createInstanceAndBottomLevelAccelStruct(Sonic::CInstanceRend
             instanceRenderObj->m_VertexSize) * sizeof(OptimizedVertexData) * 6;
 
         objGrassInstancerEx->m_vertexBuffer.Attach(new VertexBuffer(vertexByteSize));
-
-        auto& message = s_messageSender.makeMessage<MsgCreateVertexBuffer>();
-        message.vertexBufferId = objGrassInstancerEx->m_vertexBuffer->getId();
-        message.length = vertexByteSize;
-        message.allowUnorderedAccess = true;
-        s_messageSender.endMessage();
+        objGrassInstancerEx->m_vertexBuffer->create(true);
     }
 
     auto& computeMsg = s_messageSender.makeMessage<MsgComputeGrassInstancer>(
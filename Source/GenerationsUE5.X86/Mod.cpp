@@ -7,7 +7,10 @@
 #include "HalfPixel.h"
 #include "MaterialData.h"
 #include "MessageSender.h"
+#include "MessageTelemetry.h"
+#include "PayloadHeap.h"
 #include "ProcessUtil.h"
+#include "WriteCombiner.h"
 #include "RaytracingRendering.h"
 #include "InstanceData.h"
 #include "MemoryAllocator.h"
@@ -79,6 +82,8 @@ extern "C" void __declspec(dllexport) PreInit()
 extern "C" void __declspec(dllexport) Init(ModInfo_t* modInfo)
 {
     Configuration::init();
+    s_messageSender.init();
+    s_payloadHeap.init();
     D3D9::init();
     PictureData::init();
     FillTexture::init();
@@ -174,7 +179,12 @@ extern "C" void __declspec(dllexport) Init(ModInfo_t* modInfo)
 
 extern "C" void __declspec(dllexport) OnFrame()
 {
+    // Combined writes nothing drew with this frame still belong in its batch
+    WriteCombiner::flush();
+
     s_messageSender.commitMessages();
+
+    MessageTelemetry::endFrame();
 }
 
 extern "C" void __declspec(dllexport) PostInit()
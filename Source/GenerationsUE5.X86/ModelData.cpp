@@ -16,7 +16,8 @@
 #include "Configuration.h"
 
 template<typename T>
-static void traverseMeshGroup(const hh::vector<boost::shared_ptr<Hedgehog::Mirage::CMeshData>>& meshGroup, uint32_t flags, bool visible, const T& function)
+static void traverseMeshGroup(const hh::vector<boost::shared_ptr<Hedgehog::Mirage::CMeshData>>& meshGroup, uint32_t flags,
+    const Hedgehog::Mirage::CNodeGroupModelData* nodeGroupModelData, const T& function)
 {
     for (const auto& meshData : meshGroup)
     {
@@ -25,7 +26,7 @@ static void traverseMeshGroup(const hh::vector<boost::shared_ptr<Hedgehog::Mirag
         if (meshDataEx.m_spMaterial != nullptr && meshDataEx.m_indexCount > 2 && meshDataEx.m_VertexNum > 2 &&
             meshDataEx.m_indices != nullptr && meshDataEx.m_pD3DVertexBuffer != nullptr)
         {
-            function(meshDataEx, flags, visible);
+            function(meshDataEx, flags, nodeGroupModelData);
         }
     }
 }
@@ -35,23 +36,23 @@ static void traverseModelData(const TModelData& modelData, uint32_t geometryMask
 {
     if (geometryMask & GEOMETRY_FLAG_OPAQUE)
     {
-        traverseMeshGroup(modelData.m_OpaqueMeshes, GEOMETRY_FLAG_OPAQUE, true, function);
+        traverseMeshGroup(modelData.m_OpaqueMeshes, GEOMETRY_FLAG_OPAQUE, nullptr, function);
         for (const auto& nodeGroupModelData : modelData.m_NodeGroupModels)
-            traverseMeshGroup(nodeGroupModelData->m_OpaqueMeshes, GEOMETRY_FLAG_OPAQUE, nodeGroupModelData->m_Visible, function);
+            traverseMeshGroup(nodeGroupModelData->m_OpaqueMeshes, GEOMETRY_FLAG_OPAQUE, nodeGroupModelData.get(), function);
     }
 
     if (geometryMask & GEOMETRY_FLAG_PUNCH_THROUGH)
     {
-        traverseMeshGroup(modelData.m_PunchThroughMeshes, GEOMETRY_FLAG_PUNCH_THROUGH, true, function);
+        traverseMeshGroup(modelData.m_PunchThroughMeshes, GEOMETRY_FLAG_PUNCH_THROUGH, nullptr, function);
         for (const auto& nodeGroupModelData : modelData.m_NodeGroupModels)
-            traverseMeshGroup(nodeGroupModelData->m_PunchThroughMeshes, GEOMETRY_FLAG_PUNCH_THROUGH, nodeGroupModelData->m_Visible, function);
+            traverseMeshGroup(nodeGroupModelData->m_PunchThroughMeshes, GEOMETRY_FLAG_PUNCH_THROUGH, nodeGroupModelData.get(), function);
     }
 
     if (geometryMask & GEOMETRY_FLAG_TRANSPARENT)
     {
-        traverseMeshGroup(modelData.m_TransparentMeshes, GEOMETRY_FLAG_TRANSPARENT, true, function);
+        traverseMeshGroup(modelData.m_TransparentMeshes, GEOMETRY_FLAG_TRANSPARENT, nullptr, function);
         for (const auto& nodeGroupModelData : modelData.m_NodeGroupModels)
-            traverseMeshGroup(nodeGroupModelData->m_TransparentMeshes, GEOMETRY_FLAG_TRANSPARENT, nodeGroupModelData->m_Visible, function);
+            traverseMeshGroup(nodeGroupModelData->m_TransparentMeshes, GEOMETRY_FLAG_TRANSPARENT, nodeGroupModelData.get(), function);
 
         for (const auto& nodeGroupModelData : modelData.m_NodeGroupModels)
         {
@@ -61,12 +62,99 @@ static void traverseModelData(const TModelData& modelData, uint32_t geometryMask
                 if (nodeGroupModelData->m_SpecialMeshGroupModes[i] != 0)
                     geometryFlags |= GEOMETRY_FLAG_SPECIAL;
 
-                traverseMeshGroup(nodeGroupModelData->m_SpecialMeshGroups[i], geometryFlags, nodeGroupModelData->m_Visible, function);
+                traverseMeshGroup(nodeGroupModelData->m_SpecialMeshGroups[i], geometryFlags, nodeGroupModelData.get(), function);
             }
         }
     }
 }
 
+// Flattens the meshes in traversal order, along with everything the instance loop reads from their vertex declarations
+template<typename TModelData>
+static void buildMeshRecords(const TModelData& modelData, std::vector<MeshRecord>& meshRecords)
+{
+    meshRecords.clear();
+    uint32_t poseVertexOffset = 0;
+
+    traverseModelData(modelData, ~0, [&](const MeshDataEx& meshDataEx, uint32_t flags, const Hedgehog::Mirage::CNodeGroupModelData* nodeGroupModelData)
+    {
+        auto& meshRecord = meshRecords.emplace_back();
+
+        meshRecord.meshDataEx = &meshDataEx;
+        meshRecord.nodeGroupModelData = nodeGroupModelData;
+        meshRecord.flags = flags;
+        meshRecord.indexBufferId = meshDataEx.m_indices->getId();
+        meshRecord.indexCount = meshDataEx.m_indexCount;
+        meshRecord.indexOffset = meshDataEx.m_indexOffset;
+        meshRecord.vertexBufferId = reinterpret_cast<const VertexBuffer*>(meshDataEx.m_pD3DVertexBuffer)->getId();
+        meshRecord.vertexCount = meshDataEx.m_VertexNum;
+        meshRecord.vertexOffset = meshDataEx.m_VertexOffset;
+        meshRecord.vertexStride = meshDataEx.m_VertexSize;
+        meshRecord.poseVertexOffset = poseVertexOffset;
+        meshRecord.nodeCount = meshDataEx.m_NodeNum;
+
+        const auto vertexDeclaration = reinterpret_cast<const VertexDeclaration*>(
+            meshDataEx.m_VertexDeclarationPtr.m_pD3DVertexDeclaration);
+
+        auto vertexElement = vertexDeclaration->getVertexElements();
+
+        while (vertexElement->Stream != 0xFF && vertexElement->Type != D3DDECLTYPE_UNUSED)
+        {
+            switch (vertexElement->Usage)
+            {
+            case D3DDECLUSAGE_NORMAL:
+                meshRecord.normalOffset = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_TANGENT:
+                meshRecord.tangentOffset = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_BINORMAL:
+                meshRecord.binormalOffset = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_TEXCOORD:
+                assert(vertexElement->UsageIndex < 4);
+                meshRecord.texCoordOffsets[vertexElement->UsageIndex] = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_COLOR:
+                meshRecord.colorOffset = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_BLENDWEIGHT:
+                if (vertexElement->UsageIndex == 0)
+                    meshRecord.blendWeightOffset = vertexElement->Offset;
+                else
+                    meshRecord.blendWeight1Offset = vertexElement->Offset;
+                break;
+
+            case D3DDECLUSAGE_BLENDINDICES:
+                if (vertexElement->UsageIndex == 0)
+                    meshRecord.blendIndicesOffset = vertexElement->Offset;
+                else
+                    meshRecord.blendIndices1Offset = vertexElement->Offset;
+                break;
+            }
+
+            ++vertexElement;
+        }
+
+        for (size_t i = 1; i < 4; i++)
+        {
+            if (meshRecord.texCoordOffsets[i] == 0)
+                meshRecord.texCoordOffsets[i] = meshRecord.texCoordOffsets[0];
+        }
+
+        poseVertexOffset += meshDataEx.m_VertexNum * (meshDataEx.m_VertexSize + 0xC); // Extra 12 bytes for previous position
+    });
+}
+
+static bool isVisible(const MeshRecord& meshRecord)
+{
+    return meshRecord.nodeGroupModelData == nullptr || meshRecord.nodeGroupModelData->m_Visible;
+}
+
 static std::vector<uint8_t> s_matrixZeroScaledStates;
 
 static bool checkAllZeroScaled(const MeshDataEx& meshDataEx)
@@ -84,9 +172,8 @@ static bool checkAllZeroScaled(const MeshDataEx& meshDataEx)
     return false;
 }
 
-template<typename T>
 static void createBottomLevelAccelStruct(
-    const T& modelData, 
+    const std::vector<MeshRecord>& meshRecords,
     uint32_t geometryMask, 
     uint32_t& bottomLevelAccelStructId, 
     uint32_t poseVertexBufferId,
@@ -96,13 +183,13 @@ static void createBottomLevelAccelStruct(
 {
     assert(bottomLevelAccelStructId == NULL);
 
-    size_t geometryCount = 0;
-
-    traverseModelData(modelData, geometryMask, [&](const MeshDataEx& meshDataEx, uint32_t, bool visible)
+    const auto shouldInclude = [&](const MeshRecord& meshRecord)
     {
-        if (poseVertexBufferId == NULL || (visible && !checkAllZeroScaled(meshDataEx)))
-            ++geometryCount; 
-    });
+        return (meshRecord.flags & geometryMask) != 0 &&
+            (poseVertexBufferId == NULL || (isVisible(meshRecord) && !checkAllZeroScaled(*meshRecord.meshDataEx)));
+    };
+
+    const size_t geometryCount = std::count_if(meshRecords.begin(), meshRecords.end(), shouldInclude);
 
     if (geometryCount == 0)
         return;
@@ -118,76 +205,41 @@ static void createBottomLevelAccelStruct(
     memset(message.data, 0, geometryCount * sizeof(MsgCreateBottomLevelAccelStruct::GeometryDesc));
 
     auto geometryDesc = reinterpret_cast<MsgCreateBottomLevelAccelStruct::GeometryDesc*>(message.data);
-    uint32_t poseVertexOffset = 0;
 
-    traverseModelData(modelData, poseVertexBufferId != NULL ? ~0 : geometryMask, [&](const MeshDataEx& meshDataEx, uint32_t flags, bool visible)
+    for (const auto& meshRecord : meshRecords)
     {
-        uint32_t vertexOffset = meshDataEx.m_VertexOffset;
-        if (poseVertexBufferId != NULL)
-        {
-            vertexOffset = poseVertexOffset;
-            poseVertexOffset += meshDataEx.m_VertexNum * (meshDataEx.m_VertexSize + 0xC); // Extra 12 bytes for previous position
+        if (!shouldInclude(meshRecord))
+            continue;
 
-            if ((flags & geometryMask) == 0 || !visible || checkAllZeroScaled(meshDataEx))
-                return;
-
-            flags |= GEOMETRY_FLAG_POSE;
-        }
-
-        geometryDesc->flags = flags;
-        geometryDesc->indexBufferId = meshDataEx.m_indices->getId();
-        geometryDesc->indexCount = meshDataEx.m_indexCount;
-        geometryDesc->indexOffset = meshDataEx.m_indexOffset;
+        geometryDesc->flags = meshRecord.flags;
+        geometryDesc->indexBufferId = meshRecord.indexBufferId;
+        geometryDesc->indexCount = meshRecord.indexCount;
+        geometryDesc->indexOffset = meshRecord.indexOffset;
 
         if (poseVertexBufferId != NULL)
+        {
+            geometryDesc->flags |= GEOMETRY_FLAG_POSE;
             geometryDesc->vertexBufferId = poseVertexBufferId;
+            geometryDesc->vertexOffset = meshRecord.poseVertexOffset;
+        }
         else
-            geometryDesc->vertexBufferId = reinterpret_cast<const VertexBuffer*>(meshDataEx.m_pD3DVertexBuffer)->getId();
-
-        geometryDesc->vertexStride = meshDataEx.m_VertexSize;
-        geometryDesc->vertexCount = meshDataEx.m_VertexNum;
-        geometryDesc->vertexOffset = vertexOffset;
-
-        const auto vertexDeclaration = reinterpret_cast<const VertexDeclaration*>(
-            meshDataEx.m_VertexDeclarationPtr.m_pD3DVertexDeclaration);
-
-        auto vertexElement = vertexDeclaration->getVertexElements();
-        uint32_t texCoordOffsets[4]{};
-
-        while (vertexElement->Stream != 0xFF && vertexElement->Type != D3DDECLTYPE_UNUSED)
         {
-            switch (vertexElement->Usage)
-            {
-            case D3DDECLUSAGE_NORMAL:
-                geometryDesc->normalOffset = vertexElement->Offset;
-                break;
-
-            case D3DDECLUSAGE_TANGENT:
-                geometryDesc->tangentOffset = vertexElement->Offset;
-                break;
-
-            case D3DDECLUSAGE_BINORMAL:
-                geometryDesc->binormalOffset = vertexElement->Offset;
-                break;
-
-            case D3DDECLUSAGE_TEXCOORD:
-                assert(vertexElement->UsageIndex < 4);
-                texCoordOffsets[vertexElement->UsageIndex] = vertexElement->Offset;
-                break;
-
-            case D3DDECLUSAGE_COLOR:
-                geometryDesc->colorOffset = vertexElement->Offset;
-                break;
-            }
-
-            ++vertexElement;
+            geometryDesc->vertexBufferId = meshRecord.vertexBufferId;
+            geometryDesc->vertexOffset = meshRecord.vertexOffset;
         }
 
+        geometryDesc->vertexStride = meshRecord.vertexStride;
+        geometryDesc->vertexCount = meshRecord.vertexCount;
+        geometryDesc->normalOffset = meshRecord.normalOffset;
+        geometryDesc->tangentOffset = meshRecord.tangentOffset;
+        geometryDesc->binormalOffset = meshRecord.binormalOffset;
+        geometryDesc->colorOffset = meshRecord.colorOffset;
+
         for (size_t i = 0; i < 4; i++)
-            geometryDesc->texCoordOffsets[i] = texCoordOffsets[i] != 0 ? texCoordOffsets[i] : texCoordOffsets[0];
+            geometryDesc->texCoordOffsets[i] = meshRecord.texCoordOffsets[i];
 
         const auto materialDataEx = reinterpret_cast<MaterialDataEx*>(
-            meshDataEx.m_spMaterial.get());
+            meshRecord.meshDataEx->m_spMaterial.get());
 
         if (materialDataEx->m_materialId == NULL)
             materialDataEx->m_materialId = MaterialData::s_idAllocator.allocate();
@@ -195,7 +247,7 @@ static void createBottomLevelAccelStruct(
         geometryDesc->materialId = materialDataEx->m_materialId;
 
         ++geometryDesc;
-    });
+    }
 
     assert(reinterpret_cast<uint8_t*>(geometryDesc - geometryCount) == message.data);
 
@@ -238,12 +290,17 @@ HOOK(ModelDataEx*, __fastcall, ModelDataConstructor, 0x4FA400, ModelDataEx* This
     This->m_enableSkinning = false;
     new (&This->m_noAoModel) boost::shared_ptr<Hedgehog::Mirage::CModelData>();
     This->m_checkForEdgeEmission = false;
+    new (&This->m_meshRecords) std::vector<MeshRecord>();
+    This->m_poseVertexBufferSize = 0;
+    This->m_skinnedMeshCount = 0;
+    This->m_skinnedNodeCount = 0;
 
     return result;
 }
 
 HOOK(void, __fastcall, ModelDataDestructor, 0x4FA520, ModelDataEx* This)
 {
+    This->m_meshRecords.~vector();
     This->m_noAoModel.~shared_ptr();
 
     for (auto& bottomLevelAccelStructId : This->m_bottomLevelAccelStructIds)
@@ -259,14 +316,27 @@ HOOK(ModelDataEx*, __cdecl, ModelDataClone, 0xE993C0, ModelDataEx* This)
     return clonedModel;
 }
 
+// Terrain models only get traversed when their acceleration structures get created, there is nothing to cache
+static std::vector<MeshRecord> s_terrainMeshRecords;
+
 void ModelData::createBottomLevelAccelStructs(TerrainModelDataEx& terrainModelDataEx)
 {
+    bool builtMeshRecords = false;
+
     for (size_t i = 0; i < _countof(s_instanceTypes); i++)
     {
         auto& bottomLevelAccelStructId = terrainModelDataEx.m_bottomLevelAccelStructIds[i];
 
         if (bottomLevelAccelStructId == NULL)
-            createBottomLevelAccelStruct(terrainModelDataEx, s_instanceTypes[i].geometryMask, bottomLevelAccelStructId, NULL, false, false, true);
+        {
+            if (!builtMeshRecords)
+            {
+                buildMeshRecords(terrainModelDataEx, s_terrainMeshRecords);
+                builtMeshRecords = true;
+            }
+
+            createBottomLevelAccelStruct(s_terrainMeshRecords, s_instanceTypes[i].geometryMask, bottomLevelAccelStructId, NULL, false, false, true);
+        }
     }
 }
 
@@ -588,16 +658,24 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             for (auto& bottomLevelAccelStructId : modelDataEx.m_bottomLevelAccelStructIds)
                 RaytracingUtil::releaseResource(RaytracingResourceType::BottomLevelAccelStruct, bottomLevelAccelStructId);
 
-            modelDataEx.m_enableSkinning = false;
+            buildMeshRecords(modelDataEx, modelDataEx.m_meshRecords);
+
+            modelDataEx.m_poseVertexBufferSize = 0;
+            modelDataEx.m_skinnedMeshCount = 0;
+            modelDataEx.m_skinnedNodeCount = 0;
 
-            if (modelDataEx.m_NodeNum != 0)
+            for (const auto& meshRecord : modelDataEx.m_meshRecords)
             {
-                traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool)
+                modelDataEx.m_poseVertexBufferSize += meshRecord.vertexCount * (meshRecord.vertexStride + 0xC); // Extra 12 bytes for previous position
+
+                if (meshRecord.nodeCount != 0)
                 {
-                    if (meshDataEx.m_NodeNum != 0)
-                        modelDataEx.m_enableSkinning = true;
-                });
+                    ++modelDataEx.m_skinnedMeshCount;
+                    modelDataEx.m_skinnedNodeCount += meshRecord.nodeCount;
+                }
             }
+
+            modelDataEx.m_enableSkinning = modelDataEx.m_NodeNum != 0 && modelDataEx.m_skinnedMeshCount != 0;
         }
 
         modelDataEx.m_modelHash = modelHash;
@@ -629,36 +707,24 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
     {
         if (instanceInfoEx.m_poseVertexBuffer == nullptr)
         {
-            uint32_t length = 0;
-            traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool)
-            {
-                length += meshDataEx.m_VertexNum * (meshDataEx.m_VertexSize + 0xC); // Extra 12 bytes for previous position
-            });
+            const uint32_t length = modelDataEx.m_poseVertexBufferSize;
 
             if (length == 0)
                 return;
 
             instanceInfoEx.m_poseVertexBuffer.Attach(new VertexBuffer(length));
+            instanceInfoEx.m_poseVertexBuffer->create(true);
 
-            auto& message = s_messageSender.makeMessage<MsgCreateVertexBuffer>();
-            message.vertexBufferId = instanceInfoEx.m_poseVertexBuffer->getId();
-            message.allowUnorderedAccess = true;
-            message.length = length;
-            s_messageSender.endMessage();
-
-            uint32_t offset = 0;
-            traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool)
+            for (const auto& meshRecord : modelDataEx.m_meshRecords)
             {
                 auto& copyMessage = s_messageSender.makeMessage<MsgCopyVertexBuffer>();
                 copyMessage.dstVertexBufferId = instanceInfoEx.m_poseVertexBuffer->getId();
-                copyMessage.dstOffset = offset;
-                copyMessage.srcVertexBufferId = reinterpret_cast<const VertexBuffer*>(meshDataEx.m_pD3DVertexBuffer)->getId();
-                copyMessage.srcOffset = meshDataEx.m_VertexOffset;
-                copyMessage.numBytes = meshDataEx.m_VertexNum * meshDataEx.m_VertexSize;
+                copyMessage.dstOffset = meshRecord.poseVertexOffset;
+                copyMessage.srcVertexBufferId = meshRecord.vertexBufferId;
+                copyMessage.srcOffset = meshRecord.vertexOffset;
+                copyMessage.numBytes = meshRecord.vertexCount * meshRecord.vertexStride;
                 s_messageSender.endMessage();
-
-                offset += meshDataEx.m_VertexNum * (meshDataEx.m_VertexSize + 0xC); // Extra 12 bytes for previous position
-            });
+            }
         }
 
         Hedgehog::Math::CMatrix headTransformInverse;
@@ -691,16 +757,8 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
 
         if (shouldComputePose)
         {
-            uint32_t geometryCount = 0;
-            uint32_t nodeCount = 0;
-            traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool)
-            {
-                if (meshDataEx.m_NodeNum != 0)
-                {
-                    ++geometryCount;
-                    nodeCount += meshDataEx.m_NodeNum;
-                }
-            });
+            const uint32_t geometryCount = modelDataEx.m_skinnedMeshCount;
+            const uint32_t nodeCount = modelDataEx.m_skinnedNodeCount;
 
             auto& message = s_messageSender.makeMessage<MsgComputePose>(
                 matrixNum * sizeof(Hedgehog::Math::CMatrix) +
@@ -733,60 +791,27 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
 
             auto nodePalette = reinterpret_cast<uint32_t*>(geometryDesc + geometryCount);
 
-            uint32_t vertexOffset = 0;
-            traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool visible)
+            for (const auto& meshRecord : modelDataEx.m_meshRecords)
             {
-                if (meshDataEx.m_NodeNum != 0)
-                {
-                    geometryDesc->vertexCount = meshDataEx.m_VertexNum;
-                    geometryDesc->vertexBufferId = reinterpret_cast<const VertexBuffer*>(meshDataEx.m_pD3DVertexBuffer)->getId();
-                    geometryDesc->vertexStride = static_cast<uint8_t>(meshDataEx.m_VertexSize);
-                    geometryDesc->vertexOffset = meshDataEx.m_VertexOffset;
-
-                    const auto vertexDeclaration = reinterpret_cast<const VertexDeclaration*>(
-                        meshDataEx.m_VertexDeclarationPtr.m_pD3DVertexDeclaration);
+                const auto& meshDataEx = *meshRecord.meshDataEx;
+                const bool visible = isVisible(meshRecord);
 
-                    auto vertexElement = vertexDeclaration->getVertexElements();
-
-                    while (vertexElement->Stream != 0xFF && vertexElement->Type != D3DDECLTYPE_UNUSED)
-                    {
-                        const uint8_t offset = static_cast<uint8_t>(vertexElement->Offset);
-
-                        switch (vertexElement->Usage)
-                        {
-                        case D3DDECLUSAGE_NORMAL:
-                            geometryDesc->normalOffset = offset;
-                            break;
-
-                        case D3DDECLUSAGE_TANGENT:
-                            geometryDesc->tangentOffset = offset;
-                            break;
-
-                        case D3DDECLUSAGE_BINORMAL:
-                            geometryDesc->binormalOffset = offset;
-                            break;
-
-                        case D3DDECLUSAGE_BLENDWEIGHT:
-                            if (vertexElement->UsageIndex == 0)
-                                geometryDesc->blendWeightOffset = offset;
-                            else
-                                geometryDesc->blendWeight1Offset = offset;
-                            break;
-
-                        case D3DDECLUSAGE_BLENDINDICES:
-                            if (vertexElement->UsageIndex == 0)
-                                geometryDesc->blendIndicesOffset = offset;
-                            else
-                                geometryDesc->blendIndices1Offset = offset;
-                            break;
-                        }
-
-                        ++vertexElement;
-                    }
-
-                    geometryDesc->nodeCount = static_cast<uint8_t>(meshDataEx.m_NodeNum);
-
-                    for (size_t i = 0; i < meshDataEx.m_NodeNum; i++)
+                if (meshRecord.nodeCount != 0)
+                {
+                    geometryDesc->vertexCount = meshRecord.vertexCount;
+                    geometryDesc->vertexBufferId = meshRecord.vertexBufferId;
+                    geometryDesc->vertexOffset = meshRecord.vertexOffset;
+                    geometryDesc->vertexStride = static_cast<uint8_t>(meshRecord.vertexStride);
+                    geometryDesc->normalOffset = static_cast<uint8_t>(meshRecord.normalOffset);
+                    geometryDesc->tangentOffset = static_cast<uint8_t>(meshRecord.tangentOffset);
+                    geometryDesc->binormalOffset = static_cast<uint8_t>(meshRecord.binormalOffset);
+                    geometryDesc->blendWeightOffset = static_cast<uint8_t>(meshRecord.blendWeightOffset);
+                    geometryDesc->blendIndicesOffset = static_cast<uint8_t>(meshRecord.blendIndicesOffset);
+                    geometryDesc->blendWeight1Offset = static_cast<uint8_t>(meshRecord.blendWeight1Offset);
+                    geometryDesc->blendIndices1Offset = static_cast<uint8_t>(meshRecord.blendIndices1Offset);
+                    geometryDesc->nodeCount = static_cast<uint8_t>(meshRecord.nodeCount);
+
+                    for (size_t i = 0; i < meshRecord.nodeCount; i++)
                         nodePalette[i] = meshDataEx.m_pNodeIndices[i] >= message.nodeCount ? 0 : static_cast<uint32_t>(meshDataEx.m_pNodeIndices[i]);
 
                     geometryDesc->visible = visible;
@@ -798,11 +823,11 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
                     {
                         auto& smoothNormalMsg = s_messageSender.makeMessage<MsgComputeSmoothNormal>();
 
-                        smoothNormalMsg.indexBufferId = meshDataEx.m_indices->getId();
-                        smoothNormalMsg.indexOffset = meshDataEx.m_indexOffset;
-                        smoothNormalMsg.vertexStride = static_cast<uint8_t>(meshDataEx.m_VertexSize);
-                        smoothNormalMsg.vertexCount = meshDataEx.m_VertexNum;
-                        smoothNormalMsg.vertexOffset = vertexOffset;
+                        smoothNormalMsg.indexBufferId = meshRecord.indexBufferId;
+                        smoothNormalMsg.indexOffset = meshRecord.indexOffset;
+                        smoothNormalMsg.vertexStride = static_cast<uint8_t>(meshRecord.vertexStride);
+                        smoothNormalMsg.vertexCount = meshRecord.vertexCount;
+                        smoothNormalMsg.vertexOffset = meshRecord.poseVertexOffset;
                         smoothNormalMsg.normalOffset = geometryDesc->normalOffset;
                         smoothNormalMsg.vertexBufferId = instanceInfoEx.m_poseVertexBuffer->getId();
                         smoothNormalMsg.adjacencyBufferId = meshDataEx.m_adjacency->getId();
@@ -812,14 +837,12 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
                     }
 
                     ++geometryDesc;
-                    nodePalette += meshDataEx.m_NodeNum;
+                    nodePalette += meshRecord.nodeCount;
                 }
 
                 if (visible && shouldCheckForHash)
                     MaterialData::create(*meshDataEx.m_spMaterial, true);
-
-                vertexOffset += meshDataEx.m_VertexNum * (meshDataEx.m_VertexSize + 0xC); // Extra 12 bytes for previous position
-            });
+            }
 
             s_messageSender.endMessage();
         }
@@ -852,7 +875,7 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
 
             if (bottomLevelAccelStructId == NULL)
             {
-                createBottomLevelAccelStruct(modelDataEx, s_instanceTypes[i].geometryMask, 
+                createBottomLevelAccelStruct(modelDataEx.m_meshRecords, s_instanceTypes[i].geometryMask, 
                     bottomLevelAccelStructId, instanceInfoEx.m_poseVertexBuffer->getId(), allowUpdate, !allowUpdate, false);
             }
             else if (shouldComputePose)
@@ -870,10 +893,8 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
     {
         if (shouldCheckForHash)
         {
-            traverseModelData(modelDataEx, ~0, [&](const MeshDataEx& meshDataEx, uint32_t, bool)
-            {
-                MaterialData::create(*meshDataEx.m_spMaterial, true);
-            });
+            for (const auto& meshRecord : modelDataEx.m_meshRecords)
+                MaterialData::create(*meshRecord.meshDataEx->m_spMaterial, true);
         }
 
         if (instanceInfoEx.m_spPose != nullptr && instanceInfoEx.m_spPose->GetMatrixNum() != 0)
@@ -886,7 +907,7 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
             auto& bottomLevelAccelStructId = bottomLevelAccelStructIds[i];
 
             if (bottomLevelAccelStructId == NULL)
-                createBottomLevelAccelStruct(modelDataEx, s_instanceTypes[i].geometryMask, bottomLevelAccelStructId, NULL, false, false, true);
+                createBottomLevelAccelStruct(modelDataEx.m_meshRecords, s_instanceTypes[i].geometryMask, bottomLevelAccelStructId, NULL, false, false, true);
         }
     }
 
@@ -962,7 +983,7 @@ void ModelData::createBottomLevelAccelStructs(ModelDataEx& modelDataEx, Instance
 void ModelData::renderSky(Hedgehog::Mirage::CModelData& modelData)
 {
     size_t geometryCount = 0;
-    traverseModelData(modelData, ~0, [&](const MeshDataEx&, uint32_t, bool) { ++geometryCount; });
+    traverseModelData(modelData, ~0, [&](const MeshDataEx&, uint32_t, const Hedgehog::Mirage::CNodeGroupModelData*) { ++geometryCount; });
 
     if (geometryCount == 0)
         return;
@@ -982,7 +1003,7 @@ void ModelData::renderSky(Hedgehog::Mirage::CModelData& modelData)
 
     DX_PATCH::IDirect3DBaseTexture9* diffuseTexture = nullptr;
 
-    traverseModelData(modelData, ~0, [&](const MeshDataEx& meshDataEx, uint32_t flags, bool)
+    traverseModelData(modelData, ~0, [&](const MeshDataEx& meshDataEx, uint32_t flags, const Hedgehog::Mirage::CNodeGroupModelData*)
     {
         geometryDesc->flags = flags;
         geometryDesc->vertexBufferId = reinterpret_cast<const VertexBuffer*>(meshDataEx.m_pD3DVertexBuffer)->getId();
@@ -4,6 +4,33 @@
 #include "InstanceType.h"
 
 class InstanceInfoEx;
+class MeshDataEx;
+
+// Mesh data flattened for the raytracing instance loop, which needs to visit every mesh multiple times per frame
+struct MeshRecord
+{
+    const MeshDataEx* meshDataEx;
+    const Hedgehog::Mirage::CNodeGroupModelData* nodeGroupModelData; // Null for meshes that are always visible
+    uint32_t flags;
+    uint32_t indexBufferId;
+    uint32_t indexCount;
+    uint32_t indexOffset;
+    uint32_t vertexBufferId;
+    uint32_t vertexCount;
+    uint32_t vertexOffset;
+    uint32_t vertexStride;
+    uint32_t poseVertexOffset;
+    uint32_t nodeCount;
+    uint16_t normalOffset;
+    uint16_t tangentOffset;
+    uint16_t binormalOffset;
+    uint16_t colorOffset;
+    uint16_t texCoordOffsets[4];
+    uint16_t blendWeightOffset;
+    uint16_t blendWeight1Offset;
+    uint16_t blendIndicesOffset;
+    uint16_t blendIndices1Offset;
+};
 
 class TerrainModelDataEx : public Hedgehog::Mirage::CTerrainModelData
 {
@@ -21,6 +48,12 @@ public:
     bool m_enableSkinning;
     boost::shared_ptr<CModelData> m_noAoModel;
     bool m_checkForEdgeEmission;
+
+    // Rebuilt whenever the model hash changes
+    std::vector<MeshRecord> m_meshRecords;
+    uint32_t m_poseVertexBufferSize;
+    uint32_t m_skinnedMeshCount;
+    uint32_t m_skinnedNodeCount;
 };
 
 using MaterialMap = hh::map<Hedgehog::Mirage::CMaterialData*, boost::shared_ptr<Hedgehog::Mirage::CMaterialData>>;
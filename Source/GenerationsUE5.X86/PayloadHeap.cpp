@@ -0,0 +1,146 @@
+#include "PayloadHeap.h"
+
+#include "AlignmentUtil.h"
+#include "Configuration.h"
+#include "LockGuard.h"
+#include "MessageSender.h"
+
+PayloadHeap::~PayloadHeap()
+{
+    if (m_header != nullptr)
+        m_memoryMappedFile->unmap(m_header);
+}
+
+void PayloadHeap::init()
+{
+    if (Configuration::s_payloadHeapSize == 0)
+        return;
+
+    // Cursors wrap around at 4 GB, the capacity needs to divide it evenly
+    uint32_t capacity = 1;
+    while (capacity < Configuration::s_payloadHeapSize && capacity < 0x400)
+        capacity <<= 1;
+
+    capacity *= 1024 * 1024;
+
+    m_memoryMappedFile.emplace(PayloadHeapHeader::s_name, sizeof(PayloadHeapHeader) + capacity);
+    m_header = static_cast<PayloadHeapHeader*>(m_memoryMappedFile->map());
+    m_header->capacity = capacity;
+    m_header->consumedBatch.store(0);
+
+    m_threshold = Configuration::s_payloadHeapThreshold;
+}
+
+bool PayloadHeap::isEnabled() const
+{
+    return m_header != nullptr;
+}
+
+bool PayloadHeap::shouldUse(uint32_t byteSize) const
+{
+    return m_header != nullptr && byteSize >= m_threshold;
+}
+
+void PayloadHeap::reclaim()
+{
+    const uint32_t consumedBatch = m_header->consumedBatch.load(std::memory_order_acquire);
+
+    while (!m_allocations.empty())
+    {
+        const auto& allocation = m_allocations.front();
+
+        if (allocation.batchIndex == s_pendingBatch || static_cast<int32_t>(consumedBatch - allocation.batchIndex) <= 0)
+            break;
+
+        m_tail = allocation.cursor;
+        m_allocations.pop_front();
+    }
+}
+
+bool PayloadHeap::allocate(uint32_t byteSize, PayloadAllocation& allocation)
+{
+    const uint32_t capacity = m_header->capacity;
+    const uint32_t alignedSize = alignUp(byteSize, 0x10u);
+
+    if (alignedSize > capacity)
+        return false;
+
+    while (true)
+    {
+        {
+            LockGuard lock(m_mutex);
+
+            reclaim();
+
+            // Allocations never wrap around the end of the heap
+            uint32_t begin = m_head;
+            const uint32_t offset = begin & (capacity - 1);
+
+            if (offset + alignedSize > capacity)
+                begin += capacity - offset;
+
+            // Nothing is live, the skipped end of the heap doesn't need to be reclaimed
+            if (m_allocations.empty())
+                m_tail = begin;
+
+            const uint32_t end = begin + alignedSize;
+
+            if (end - m_tail <= capacity)
+            {
+                m_allocations.push_back({ end, s_pendingBatch });
+                m_head = end;
+
+                allocation.offset = begin & (capacity - 1);
+                allocation.data = m_header->getData() + allocation.offset;
+                allocation.byteSize = byteSize;
+                allocation.cursor = end;
+
+                return true;
+            }
+
+            // Committing from here would deadlock if the calling thread has a message open, and
+            // allocations that aren't fenced yet can't be reclaimed until their message is done.
+            const auto& oldest = m_allocations.front();
+
+            if (oldest.batchIndex == s_pendingBatch || static_cast<int32_t>(oldest.batchIndex - s_messageSender.getCommitIndex()) >= 0)
+                return false;
+        }
+
+        if (*s_shouldExit)
+            return false;
+
+        // Heap is full of committed batches, wait for the bridge to consume them
+        std::this_thread::yield();
+    }
+}
+
+bool PayloadHeap::allocateCommitting(uint32_t byteSize, PayloadAllocation& allocation)
+{
+    if (alignUp(byteSize, 0x10u) > m_header->capacity)
+        return false;
+
+    while (!allocate(byteSize, allocation))
+    {
+        if (*s_shouldExit)
+            return false;
+
+        // Fences the allocations of the current batch, which lets them get reclaimed
+        s_messageSender.commitMessages();
+    }
+
+    return true;
+}
+
+void PayloadHeap::fence(const PayloadAllocation& allocation)
+{
+    LockGuard lock(m_mutex);
+
+    for (auto it = m_allocations.rbegin(); it != m_allocations.rend(); ++it)
+    {
+        if (it->cursor == allocation.cursor)
+        {
+            it->batchIndex = s_messageSender.getCommitIndex();
+            break;
+        }
+    }
+}
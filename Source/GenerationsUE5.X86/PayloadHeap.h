@@ -0,0 +1,63 @@
+#pragma once
+
+#include "MemoryMappedFile.h"
+#include "Mutex.h"
+#include "PayloadHeapHeader.h"
+
+#include <deque>
+#include <optional>
+
+struct PayloadAllocation
+{
+    uint8_t* data;
+    uint32_t offset;
+    uint32_t byteSize;
+    uint32_t cursor;
+};
+
+// FIFO suballocator over the payload heap mapping. Allocations are reclaimed
+// in order, once the bridge reports the batch that referenced them as consumed.
+class PayloadHeap
+{
+protected:
+    static constexpr uint32_t s_pendingBatch = ~0u;
+
+    struct Allocation
+    {
+        uint32_t cursor;
+        uint32_t batchIndex;
+    };
+
+    std::optional<MemoryMappedFile> m_memoryMappedFile;
+    PayloadHeapHeader* m_header = nullptr;
+    uint32_t m_threshold = 0;
+
+    Mutex m_mutex;
+    uint32_t m_head = 0;
+    uint32_t m_tail = 0;
+    std::deque<Allocation> m_allocations;
+
+    void reclaim();
+
+public:
+    ~PayloadHeap();
+
+    void init();
+
+    bool isEnabled() const;
+    bool shouldUse(uint32_t byteSize) const;
+
+    // Waits for the bridge only while the memory is held by batches that were already
+    // committed, fails when the payload needs to fall back to an inline message.
+    bool allocate(uint32_t byteSize, PayloadAllocation& allocation);
+
+    // Commits to make room when the heap is held by the current batch. Must not be called
+    // with a message open, fails only for payloads larger than the heap or when exiting.
+    bool allocateCommitting(uint32_t byteSize, PayloadAllocation& allocation);
+
+    // Needs to be called while the message referencing the allocation is pending,
+    // so that the allocation gets tied to the batch the message ends up in.
+    void fence(const PayloadAllocation& allocation);
+};
+
+inline PayloadHeap s_payloadHeap;
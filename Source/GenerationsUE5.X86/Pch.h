@@ -24,6 +24,7 @@ using Microsoft::WRL::ComPtr;
 #include <Helpers.h>
 #define XXH_STATIC_LINKING_ONLY
 #include <xxhash.h>
+#include <lz4.h>
 #include <IniFile.h>
 #include <HE1ML/ModLoader.h>
 #include <imgui.h>
@@ -1,9 +1,15 @@
 #include "PictureData.h"
 
+#include "Configuration.h"
 #include "Message.h"
+#include "MessageCompression.h"
 #include "MessageSender.h"
+#include "PayloadHeap.h"
 #include "Texture.h"
 
+// Small enough to not force a commit every part
+static constexpr uint32_t s_texturePartSize = 16 * 1024 * 1024;
+
 HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
      Hedgehog::Mirage::CPictureData* pictureData,
      uint8_t* data,
@@ -14,7 +20,20 @@ HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
     {
         assert(pictureData->m_pD3DTexture == nullptr);
 
-        if (*reinterpret_cast<uint32_t*>(data) == MAKEFOURCC('D', 'D', 'S', ' ') && MessageSender::canMakeMessage<MsgMakeTexture>(dataSize))
+        const bool isDds = *reinterpret_cast<uint32_t*>(data) == MAKEFOURCC('D', 'D', 'S', ' ');
+
+        const uint8_t* compressedData = nullptr;
+        uint32_t compressedSize = 0;
+        if (isDds && Configuration::s_compressTextures)
+            compressedData = MessageCompression::compress(data, dataSize, compressedSize);
+
+        const bool useCompression = compressedData != nullptr && MessageSender::canMakeMessage<MsgMakeTextureCompressed>(compressedSize);
+
+        // Large textures go to the payload heap, no message is open yet so it can commit to make room
+        PayloadAllocation payload{};
+        const bool usePayloadHeap = isDds && !useCompression && s_payloadHeap.shouldUse(dataSize) && s_payloadHeap.allocateCommitting(dataSize, payload);
+
+        if (isDds)
         {
             const auto texture = new Texture(
                 *reinterpret_cast<uint32_t*>(data + 16),
@@ -24,15 +43,60 @@ HOOK(void, __cdecl, PictureDataMake, Hedgehog::Mirage::fpCPictureDataMake0,
             pictureData->m_pD3DTexture = reinterpret_cast<DX_PATCH::IDirect3DBaseTexture9*>(texture);
             pictureData->m_Type = Hedgehog::Mirage::ePictureType_Texture;
 
-            auto& message = s_messageSender.makeMessage<MsgMakeTexture>(dataSize);
+            if (useCompression)
+            {
+                auto& message = s_messageSender.makeMessage<MsgMakeTextureCompressed>(compressedSize);
+
+                message.textureId = texture->getId();
+                message.uncompressedSize = dataSize;
+                message.dataSize = compressedSize;
+                memcpy(message.data, compressedData, compressedSize);
+
+                s_messageSender.endMessage();
+            }
+            else if (usePayloadHeap)
+            {
+                memcpy(payload.data, data, dataSize);
 
-            message.textureId = texture->getId();
+                auto& message = s_messageSender.makeMessage<MsgMakeTextureFromHeap>();
+
+                message.textureId = texture->getId();
+                message.payloadOffset = payload.offset;
+                message.payloadSize = payload.byteSize;
+
+                s_payloadHeap.fence(payload);
+                s_messageSender.endMessage();
+            }
+            else if (MessageSender::canMakeMessage<MsgMakeTexture>(dataSize))
+            {
+                auto& message = s_messageSender.makeMessage<MsgMakeTexture>(dataSize);
+
+                message.textureId = texture->getId();
 #if _DEBUG
-            strcpy(message.textureName, pictureData->m_TypeAndName.c_str() + 15);
+                strcpy(message.textureName, pictureData->m_TypeAndName.c_str() + 15);
 #endif
-            memcpy(message.data, data, dataSize);
+                memcpy(message.data, data, dataSize);
+
+                s_messageSender.endMessage();
+            }
+            else
+            {
+                // Fits neither a batch nor the heap, batches get committed between the parts as needed
+                for (uint32_t offset = 0; offset < dataSize; offset += s_texturePartSize)
+                {
+                    const uint32_t partSize = std::min<uint32_t>(static_cast<uint32_t>(dataSize) - offset, s_texturePartSize);
+
+                    auto& message = s_messageSender.makeMessage<MsgMakeTexturePart>(partSize);
+
+                    message.textureId = texture->getId();
+                    message.totalSize = static_cast<uint32_t>(dataSize);
+                    message.offset = offset;
+                    message.dataSize = partSize;
+                    memcpy(message.data, data + offset, partSize);
 
-            s_messageSender.endMessage();
+                    s_messageSender.endMessage();
+                }
+            }
         }
         else
         {
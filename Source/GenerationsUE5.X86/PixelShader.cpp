@@ -1,11 +1,18 @@
 #include "PixelShader.h"
 
+#include "ShaderCache.h"
+
 static std::atomic<uint32_t> s_curId = 0;
 
 PixelShader::PixelShader() : m_id(++s_curId)
 {
 }
 
+PixelShader::~PixelShader()
+{
+    ShaderCache::releasePixelShader(m_id);
+}
+
 uint32_t PixelShader::getId() const
 {
     return m_id;
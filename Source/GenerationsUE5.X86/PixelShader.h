@@ -10,6 +10,7 @@ protected:
     uint32_t m_id;
 public:
     PixelShader();
+    ~PixelShader() override;
 
     uint32_t getId() const;
 
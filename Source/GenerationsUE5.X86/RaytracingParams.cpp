@@ -6,6 +6,7 @@
 #include "EnvironmentMode.h"
 #include "LightData.h"
 #include "MessageSender.h"
+#include "MessageTelemetry.h"
 #include "QuickBoot.h"
 #include "StageSelection.h"
 #include "Logger.h"
@@ -613,8 +614,23 @@ void RaytracingParams::imguiWindow()
                         ImGui::Text("Average Scene Traverse: %g ms (%g FPS)", sceneTraverseDurationAvg, 1000.0 / sceneTraverseDurationAvg);
                     }
 
+                    if (s_messageSender.isCommitPipelined())
+                        ImGui::Text("Commit Pipeline Latency: %g ms", s_messageSender.getPipelineLatency());
+
                     ImGui::Text("Vertex Buffer Wasted Memory: %g MB", static_cast<double>(VertexBuffer::s_wastedMemory) / (1024.0 * 1024.0));
                     ImGui::Text("Index Buffer Wasted Memory: %g MB", static_cast<double>(IndexBuffer::s_wastedMemory) / (1024.0 * 1024.0));
+
+                    if (Configuration::s_poolSmallBuffers)
+                    {
+                        ImGui::Text("Vertex Buffer Pool: %u heaps, %g MB used, %g MB wasted", s_vertexBufferPool.getHeapCount(),
+                            static_cast<double>(s_vertexBufferPool.getUsedMemory()) / (1024.0 * 1024.0),
+                            static_cast<double>(s_vertexBufferPool.getWastedMemory()) / (1024.0 * 1024.0));
+
+                        ImGui::Text("Index Buffer Pool: %u heaps, %g MB used, %g MB wasted", s_indexBufferPool.getHeapCount(),
+                            static_cast<double>(s_indexBufferPool.getUsedMemory()) / (1024.0 * 1024.0),
+                            static_cast<double>(s_indexBufferPool.getWastedMemory()) / (1024.0 * 1024.0));
+                    }
+
                     ImGui::Text("Memory Mapped File Committed Size: %g MB", static_cast<double>(s_messageSender.getLastCommittedSize()) / (1024.0 * 1024.0));
                 }
 
@@ -622,6 +638,15 @@ void RaytracingParams::imguiWindow()
                 ImGui::EndTabItem();
             }
 
+            if (ImGui::BeginTabItem("Telemetry"))
+            {
+                if (ImGui::BeginChild("Child"))
+                    MessageTelemetry::renderImgui();
+
+                ImGui::EndChild();
+                ImGui::EndTabItem();
+            }
+
             if (ImGui::BeginTabItem("Logs"))
             {
                 if (ImGui::BeginChild("Child"))
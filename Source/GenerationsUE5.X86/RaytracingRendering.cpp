@@ -18,6 +18,7 @@
 #include "Logger.h"
 #include "WallJumpBlock.h"
 #include "Frustum.h"
+#include "WriteCombiner.h"
 
 static void createInstancesAndBottomLevelAccelStructs(Hedgehog::Mirage::CRenderable* renderable)
 {
@@ -306,6 +307,9 @@ static void __cdecl implOfTraceRays(void* a1)
 
             s_curBackGroundScale = *reinterpret_cast<const float*>(0x1A489EC);
 
+            // The sky, instances and acceleration structures made below read vertex and index buffers
+            WriteCombiner::flush();
+
             if (s_curSky != prevSky || s_curBackGroundScale != prevBackGroundScale)
             {
                 if (s_curSky != nullptr)
@@ -404,6 +408,9 @@ static void __cdecl implOfTraceRays(void* a1)
             s_prevSkyColor = RaytracingParams::s_skyColor;
             s_prevGroundColor = RaytracingParams::s_groundColor;
 
+            // The light constants set above are read when tracing
+            reinterpret_cast<Device*>(d3dDevice)->flushPendingState();
+
             auto& traceRaysMessage = s_messageSender.makeMessage<MsgTraceRays>();
 
             traceRaysMessage.width = *reinterpret_cast<uint16_t*>(**static_cast<uintptr_t**>(a1) + 4);
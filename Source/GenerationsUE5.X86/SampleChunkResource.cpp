@@ -1,20 +1,14 @@
 #include "SampleChunkResource.h"
 
-struct SampleChunkNode
-{
-    uint32_t flagsAndSize;
-    uint32_t value;
-    char name[8];
-};
-
 HOOK(void, __fastcall, SampleChunkResourceResolvePointer, 0x732E50, void* This)
 {
     const auto headerV2 = reinterpret_cast<SampleChunkHeaderV2*>(This);
 
     SampleChunkResource::s_optimizedVertexFormat = false;
     SampleChunkResource::s_triangleTopology = false;
+    SampleChunkResource::s_adjacencyTable = nullptr;
 
-    if (_byteswap_ulong(headerV2->fileSize) & 0x80000000)
+    if (_byteswap_ulong(headerV2->fileSize) & SampleChunkHeaderV2::s_flag)
     {
         const uint32_t* offsets = reinterpret_cast<uint32_t*>(
             reinterpret_cast<uint8_t*>(This) + _byteswap_ulong(headerV2->relocationTable));
@@ -28,13 +22,17 @@ HOOK(void, __fastcall, SampleChunkResourceResolvePointer, 0x732E50, void* This)
         }
 
         auto node = reinterpret_cast<SampleChunkNode*>(headerV2 + 1);
-        while (strncmp(node->name, "Contexts", sizeof(node->name)) != 0)
+        while (strncmp(node->name, SampleChunkNode::s_contexts, sizeof(node->name)) != 0)
         {
-            if (strncmp(node->name, "GensRT  ", sizeof(node->name)) == 0)
-                SampleChunkResource::s_optimizedVertexFormat = (_byteswap_ulong(node->value) == 1u);
+            if (strncmp(node->name, SampleChunkNode::s_gensRT, sizeof(node->name)) == 0)
+                SampleChunkResource::s_optimizedVertexFormat = (_byteswap_ulong(node->value) == SampleChunkNode::s_optimizedVertexFormat);
+
+            else if (strncmp(node->name, SampleChunkNode::s_topology, sizeof(node->name)) == 0)
+                SampleChunkResource::s_triangleTopology = (_byteswap_ulong(node->value) == SampleChunkNode::s_triangleList);
 
-            else if (strncmp(node->name, "Topology", sizeof(node->name)) == 0)
-                SampleChunkResource::s_triangleTopology = (_byteswap_ulong(node->value) == 3u);
+            // Already relocated by now
+            else if (strncmp(node->name, SampleChunkNode::s_adjacencyTable, sizeof(node->name)) == 0)
+                SampleChunkResource::s_adjacencyTable = reinterpret_cast<const SampleChunkAdjacencyTable*>(node->value);
 
             ++node;
         }
@@ -50,6 +48,22 @@ HOOK(void, __fastcall, SampleChunkResourceResolvePointer, 0x732E50, void* This)
     }
 }
 
+const SampleChunkAdjacency* SampleChunkResource::findAdjacency(const void* mesh)
+{
+    if (s_adjacencyTable == nullptr)
+        return nullptr;
+
+    const auto adjacencies = reinterpret_cast<const SampleChunkAdjacency*>(s_adjacencyTable + 1);
+
+    for (size_t i = 0; i < _byteswap_ulong(s_adjacencyTable->count); i++)
+    {
+        if (adjacencies[i].mesh == reinterpret_cast<uint32_t>(mesh))
+            return &adjacencies[i];
+    }
+
+    return nullptr;
+}
+
 void SampleChunkResource::init()
 {
     INSTALL_HOOK(SampleChunkResourceResolvePointer);
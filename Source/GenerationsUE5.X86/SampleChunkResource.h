@@ -1,27 +1,16 @@
 #pragma once
 
-struct SampleChunkHeaderV1
-{
-    uint32_t fileSize;
-    uint32_t version;
-    uint32_t dataSize;
-    uint32_t data;
-    uint32_t relocationTable;
-    uint32_t fileName;
-};
-
-struct SampleChunkHeaderV2
-{
-    uint32_t fileSize;
-    uint32_t version;
-    uint32_t relocationTable;
-    uint32_t offsetCount;
-};
+#include "SampleChunk.h"
 
 struct SampleChunkResource
 {
-    static inline bool s_optimizedVertexFormat = false;
-    static inline bool s_triangleTopology = false;
+    // Per thread, as resources can be loaded on multiple threads at once
+    static inline thread_local bool s_optimizedVertexFormat = false;
+    static inline thread_local bool s_triangleTopology = false;
+    static inline thread_local const SampleChunkAdjacencyTable* s_adjacencyTable = nullptr;
+
+    // Precomputed adjacency of the mesh in the last resolved resource, if it has any
+    static const SampleChunkAdjacency* findAdjacency(const void* mesh);
 
     static void init();
 };
\ No newline at end of file
@@ -1,7 +1,28 @@
 #include "ShaderCache.h"
 
+#include "Configuration.h"
+#include "LockGuard.h"
+#include "MemoryMappedFile.h"
 #include "Message.h"
 #include "MessageSender.h"
+#include "Mutex.h"
+#include "ShaderCacheMissRing.h"
+#include "ShaderManifest.h"
+
+static std::vector<uint64_t> s_manifest;
+static std::optional<MemoryMappedFile> s_memoryMappedFile;
+static ShaderCacheMissRingHeader* s_missRing;
+
+// Bytecode of live shaders sent by hash, kept around in case the bridge reports a miss
+struct ShaderFunction
+{
+    uint64_t hash;
+    std::vector<uint8_t> bytecode;
+};
+
+static Mutex s_mutex;
+static std::unordered_map<uint32_t, ShaderFunction> s_vertexShaderFunctions;
+static std::unordered_map<uint32_t, ShaderFunction> s_pixelShaderFunctions;
 
 HOOK(void, __fastcall, GameplayFlowStageEnter, 0xD05530, void* This)
 {
@@ -23,4 +44,129 @@ void ShaderCache::init()
 {
     INSTALL_HOOK(GameplayFlowStageEnter);
     INSTALL_HOOK(GameplayFlowTitleEnter);
+
+    if (Configuration::s_persistentShaderCache)
+    {
+        s_manifest = ShaderManifest::load(ShaderManifest::s_filePath);
+
+        s_memoryMappedFile.emplace(ShaderCacheMissRingHeader::s_name, sizeof(ShaderCacheMissRingHeader));
+        s_missRing = static_cast<ShaderCacheMissRingHeader*>(s_memoryMappedFile->map());
+        s_missRing->producerCursor.store(0);
+        s_missRing->consumerCursor.store(0);
+        s_missRing->overflowed.store(0);
+    }
+}
+
+template<typename TMessage>
+static bool createShader(std::unordered_map<uint32_t, ShaderFunction>& functions, uint32_t shaderId, const void* function, uint32_t functionSize)
+{
+    if (s_missRing == nullptr)
+        return false;
+
+    const uint64_t hash = ShaderManifest::computeHash(function, functionSize);
+    if (!std::binary_search(s_manifest.begin(), s_manifest.end(), hash))
+        return false;
+
+    {
+        LockGuard lock(s_mutex);
+        auto& shaderFunction = functions[shaderId];
+        shaderFunction.hash = hash;
+        shaderFunction.bytecode.assign(static_cast<const uint8_t*>(function), static_cast<const uint8_t*>(function) + functionSize);
+    }
+
+    auto& message = s_messageSender.makeMessage<TMessage>();
+
+    if constexpr (std::is_same_v<TMessage, MsgCreateVertexShaderFromCache>)
+        message.vertexShaderId = shaderId;
+    else
+        message.pixelShaderId = shaderId;
+
+    message.hash = hash;
+
+    s_messageSender.endMessage();
+
+    return true;
+}
+
+bool ShaderCache::createVertexShader(uint32_t vertexShaderId, const void* function, uint32_t functionSize)
+{
+    return createShader<MsgCreateVertexShaderFromCache>(s_vertexShaderFunctions, vertexShaderId, function, functionSize);
+}
+
+bool ShaderCache::createPixelShader(uint32_t pixelShaderId, const void* function, uint32_t functionSize)
+{
+    return createShader<MsgCreatePixelShaderFromCache>(s_pixelShaderFunctions, pixelShaderId, function, functionSize);
+}
+
+void ShaderCache::releaseVertexShader(uint32_t vertexShaderId)
+{
+    LockGuard lock(s_mutex);
+    s_vertexShaderFunctions.erase(vertexShaderId);
+}
+
+void ShaderCache::releasePixelShader(uint32_t pixelShaderId)
+{
+    LockGuard lock(s_mutex);
+    s_pixelShaderFunctions.erase(pixelShaderId);
+}
+
+static void sendShader(bool isPixelShader, uint32_t shaderId, const std::vector<uint8_t>& bytecode)
+{
+    if (isPixelShader)
+    {
+        auto& message = s_messageSender.makeMessage<MsgCreatePixelShader>(static_cast<uint32_t>(bytecode.size()));
+        message.pixelShaderId = shaderId;
+        memcpy(message.data, bytecode.data(), bytecode.size());
+    }
+    else
+    {
+        auto& message = s_messageSender.makeMessage<MsgCreateVertexShader>(static_cast<uint32_t>(bytecode.size()));
+        message.vertexShaderId = shaderId;
+        memcpy(message.data, bytecode.data(), bytecode.size());
+    }
+
+    s_messageSender.endMessage();
+}
+
+void ShaderCache::processMisses()
+{
+    if (s_missRing == nullptr)
+        return;
+
+    // Clear the flag before reading the cursor, an overflow after this point gets handled next frame
+    const bool overflowed = s_missRing->overflowed.exchange(0, std::memory_order_acquire) != 0;
+    const uint32_t producerCursor = s_missRing->producerCursor.load(std::memory_order_acquire);
+    uint32_t consumerCursor = s_missRing->consumerCursor.load(std::memory_order_relaxed);
+
+    if (!overflowed && consumerCursor == producerCursor)
+        return;
+
+    LockGuard lock(s_mutex);
+
+    if (overflowed)
+    {
+        // Misses got dropped, resend everything, which covers the ones still in the ring too
+        for (const auto& [shaderId, function] : s_vertexShaderFunctions)
+            sendShader(false, shaderId, function.bytecode);
+
+        for (const auto& [shaderId, function] : s_pixelShaderFunctions)
+            sendShader(true, shaderId, function.bytecode);
+
+        consumerCursor = producerCursor;
+    }
+
+    for (; consumerCursor != producerCursor; ++consumerCursor)
+    {
+        const auto& miss = s_missRing->misses[consumerCursor % ShaderCacheMissRingHeader::s_capacity];
+        const auto& functions = miss.isPixelShader ? s_pixelShaderFunctions : s_vertexShaderFunctions;
+
+        // The shader might've been released and its id reused since the miss was reported
+        const auto findResult = functions.find(miss.shaderId);
+        if (findResult == functions.end() || findResult->second.hash != miss.hash)
+            continue;
+
+        sendShader(miss.isPixelShader != 0, miss.shaderId, findResult->second.bytecode);
+    }
+
+    s_missRing->consumerCursor.store(consumerCursor, std::memory_order_release);
 }
@@ -3,4 +3,15 @@
 struct ShaderCache
 {
     static void init();
-};
\ No newline at end of file
+
+    // Sends only the hash if the bridge has the bytecode on disk, returns false
+    // if the shader needs to be created with its bytecode instead.
+    static bool createVertexShader(uint32_t vertexShaderId, const void* function, uint32_t functionSize);
+    static bool createPixelShader(uint32_t pixelShaderId, const void* function, uint32_t functionSize);
+
+    static void releaseVertexShader(uint32_t vertexShaderId);
+    static void releasePixelShader(uint32_t pixelShaderId);
+
+    // Resends the bytecode of shaders the bridge couldn't find on disk
+    static void processMisses();
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <bitset>
+
+// Shadow copy of a shader constant register file. Writes that don't change
+// a register are dropped, the rest get marked dirty and are sent as contiguous
+// ranges the next time the file is flushed.
+template <typename T, uint32_t Count>
+class ShaderConstantFile
+{
+protected:
+    T m_values[Count]{};
+    std::bitset<Count> m_valid;
+    std::bitset<Count> m_dirty;
+    uint32_t m_dirtyBegin = Count;
+    uint32_t m_dirtyEnd = 0;
+
+public:
+    void set(uint32_t startRegister, const T* values, uint32_t count);
+
+    bool isDirty() const;
+
+    // Calls the function with (startRegister, values, count) for every dirty range.
+    template <typename TFunction>
+    void flush(const TFunction& function);
+};
+
+#include "ShaderConstantFile.inl"
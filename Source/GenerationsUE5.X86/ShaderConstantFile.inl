@@ -0,0 +1,54 @@
+template <typename T, uint32_t Count>
+void ShaderConstantFile<T, Count>::set(uint32_t startRegister, const T* values, uint32_t count)
+{
+    assert(startRegister + count <= Count);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t index = startRegister + i;
+
+        // Compare the bits, so that NaNs and negative zeros don't get treated as equal
+        if (!m_valid[index] || memcmp(&m_values[index], &values[i], sizeof(T)) != 0)
+        {
+            memcpy(&m_values[index], &values[i], sizeof(T));
+            m_valid.set(index);
+            m_dirty.set(index);
+
+            m_dirtyBegin = std::min(m_dirtyBegin, index);
+            m_dirtyEnd = std::max(m_dirtyEnd, index + 1);
+        }
+    }
+}
+
+template <typename T, uint32_t Count>
+bool ShaderConstantFile<T, Count>::isDirty() const
+{
+    return m_dirtyBegin < m_dirtyEnd;
+}
+
+template <typename T, uint32_t Count>
+template <typename TFunction>
+void ShaderConstantFile<T, Count>::flush(const TFunction& function)
+{
+    uint32_t index = m_dirtyBegin;
+
+    while (index < m_dirtyEnd)
+    {
+        if (!m_dirty[index])
+        {
+            ++index;
+            continue;
+        }
+
+        uint32_t end = index + 1;
+        while (end < m_dirtyEnd && m_dirty[end])
+            ++end;
+
+        function(index, &m_values[index], end - index);
+        index = end;
+    }
+
+    m_dirty.reset();
+    m_dirtyBegin = Count;
+    m_dirtyEnd = 0;
+}
@@ -12,7 +12,7 @@ static void checkSampleChunkV2Header(void* data)
     if (data != nullptr)
     {
         ShareVertexBuffer::s_loadingSampleChunkV2 =
-            (_byteswap_ulong(reinterpret_cast<const SampleChunkHeaderV2*>(data)->fileSize) & 0x80000000) != 0;
+            (_byteswap_ulong(reinterpret_cast<const SampleChunkHeaderV2*>(data)->fileSize) & SampleChunkHeaderV2::s_flag) != 0;
 
         if (ShareVertexBuffer::s_loadingSampleChunkV2)
             reinterpret_cast<SampleChunkHeaderV1*>(data)->version = 0x05000000;
@@ -2,8 +2,9 @@
 
 struct ShareVertexBuffer
 {
-    static inline bool s_loadingSampleChunkV2;
-    static inline bool s_makingModelData;
+    // Per thread, as models can be loaded on multiple threads at once
+    static inline thread_local bool s_loadingSampleChunkV2;
+    static inline thread_local bool s_makingModelData;
 
     static void init();
 };
\ No newline at end of file
@@ -4,81 +4,111 @@
 #include "Message.h"
 #include "MessageSender.h"
 
-HOOK(void, __stdcall, CPlayerSpeedContext_Ctor, 0xE668B0, Sonic::Player::CPlayerSpeed* This, void* Unk)
+static constexpr size_t s_maxBoneCount = 0x100;
+
+static struct
 {
-	originalCPlayerSpeedContext_Ctor(This, Unk);
+	const Hedgehog::Mirage::CModelData* modelData;
+	bool isModern;
+	std::vector<Hedgehog::Math::CMatrix> inverseBindMatrices;
+	std::vector<MsgSonicUpdate::Bone> sentBones;
+} s_sonic;
+
+static void copyMatrix(float (&dst)[3][4], const Hedgehog::Math::CMatrix& src)
+{
+	for (size_t i = 0; i < 3; i++)
+	{
+		for (size_t j = 0; j < 4; j++)
+			dst[i][j] = src(i, j);
+	}
+}
+
+// Without model data the skeleton is sent empty, so that the bridge still learns about the player type
+static void sendSonicInit(const Hedgehog::Mirage::CModelData* modelData, size_t boneCount)
+{
+	s_sonic.modelData = modelData;
+	s_sonic.inverseBindMatrices.resize(boneCount);
+	s_sonic.sentBones.resize(boneCount);
+
+	auto& message = s_messageSender.makeMessage<MsgSonicInit>(boneCount * sizeof(MsgSonicInit::Bone));
+
+	message.bIsModern = s_sonic.isModern;
+	message.boneCount = static_cast<uint32_t>(boneCount);
+
+	auto bones = reinterpret_cast<MsgSonicInit::Bone*>(message.data);
 
-	bool bIsModern = (Sonic::Player::CSonicClassicContext::GetInstance() == nullptr) && (Sonic::Player::CSonicSpContext::GetInstance() == nullptr);
+	for (size_t i = 0; i < boneCount; i++)
+	{
+		s_sonic.inverseBindMatrices[i] = modelData->m_spNodeMatrices[i].m_Matrix.inverse();
 
-	auto& message = s_messageSender.makeMessage<MsgSonicInit>();
+		bones[i].name[0] = '\0';
+		strncat(bones[i].name, modelData->m_spNodes[i].m_Name.c_str(), sizeof(bones[i].name) - 1);
+		copyMatrix(bones[i].inverseBindMatrix, s_sonic.inverseBindMatrices[i]);
 
-	message.bIsModern = bIsModern;
+		// Make sure every bone is sent with the first update
+		memset(&s_sonic.sentBones[i], 0xFF, sizeof(MsgSonicUpdate::Bone));
+	}
 
 	s_messageSender.endMessage();
 }
 
+HOOK(void, __stdcall, CPlayerSpeedContext_Ctor, 0xE668B0, Sonic::Player::CPlayerSpeed* This, void* Unk)
+{
+	originalCPlayerSpeedContext_Ctor(This, Unk);
+
+	s_sonic.isModern = (Sonic::Player::CSonicClassicContext::GetInstance() == nullptr) && (Sonic::Player::CSonicSpContext::GetInstance() == nullptr);
+
+	// The skeleton gets sent with the next update that has a pose
+	sendSonicInit(nullptr, 0);
+}
+
 HOOK(void, __fastcall, CPlayerSpeedUpdate, 0xE6BF20, Sonic::Player::CPlayerSpeed* This, void* Edx, const hh::fnd::SUpdateInfo& updateInfo)
 {
 	originalCPlayerSpeedUpdate(This, Edx, updateInfo);
 
 	auto animationPose = This->m_spAnimationPose;
-	auto skeleton = (hk2010_2_0::hkaSkeleton*)This->m_spAnimationPose->m_pAnimData->m_pSkeleton;
 	
-    auto sonic = This->GetContext();
+	auto sonic = This->GetContext();
 	bool bIsSuper = sonic->m_pStateFlag->m_Flags[sonic->eStateFlag_InvokeSuperSonic];
 
-	auto& message = s_messageSender.makeMessage<MsgSonicUpdate>();
+	size_t boneCount = 0;
+
+	if (animationPose)
+	{
+		boneCount = std::min<size_t>(animationPose->m_numBones, s_maxBoneCount);
+
+		if (s_sonic.modelData != animationPose->m_spModelData.get() || s_sonic.inverseBindMatrices.size() != boneCount)
+			sendSonicInit(animationPose->m_spModelData.get(), boneCount);
+	}
+
+	// Gather the bones that changed since the last update
+	MsgSonicUpdate::Bone changedBones[s_maxBoneCount];
+	uint32_t changedBoneCount = 0;
+
+	for (size_t i = 0; i < boneCount; i++)
+	{
+		auto& bone = changedBones[changedBoneCount];
+		bone.index = static_cast<uint8_t>(i);
+		copyMatrix(bone.matrix, animationPose->GetMatrixList()[i] * s_sonic.inverseBindMatrices[i]);
+
+		if (memcmp(&bone, &s_sonic.sentBones[i], sizeof(MsgSonicUpdate::Bone)) != 0)
+		{
+			s_sonic.sentBones[i] = bone;
+			++changedBoneCount;
+		}
+	}
+
+	auto& message = s_messageSender.makeMessage<MsgSonicUpdate>(changedBoneCount * sizeof(MsgSonicUpdate::Bone));
 
 	message.bIsSuper = bIsSuper;
 	const auto mat = sonic->m_spMatrixNode->GetWorldMatrix();
 
-	message.matrix[0] = mat.data()[0];
-	message.matrix[1] = mat.data()[1];
-	message.matrix[2] = mat.data()[2];
-	message.matrix[3] = mat.data()[3];
-	message.matrix[4] = mat.data()[4];
-	message.matrix[5] = mat.data()[5];
-	message.matrix[6] = mat.data()[6];
-	message.matrix[7] = mat.data()[7];
-	message.matrix[8] = mat.data()[8];
-	message.matrix[9] = mat.data()[9];
-	message.matrix[10] = mat.data()[10];
-	message.matrix[11] = mat.data()[11];
-	message.matrix[12] = mat.data()[12];
-	message.matrix[13] = mat.data()[13];
-	message.matrix[14] = mat.data()[14];
-	message.matrix[15] = mat.data()[15];
-
-	if (!animationPose) return;
-
-	message.boneCount = animationPose->m_numBones;
-	
-	for (int i = 0; i < message.boneCount; i++)
-	{		
-		message.boneNames[i][0] = '\0';
-		strncat(message.boneNames[i], animationPose->m_spModelData->m_spNodes[i].m_Name.c_str(), 0xFF);
-
-		auto bindMat = animationPose->m_spModelData->m_spNodeMatrices[i].m_Matrix;
-		auto boneMat = animationPose->GetMatrixList()[i] * bindMat.inverse();
-
-		message.boneMatrices[i][0] = boneMat.data()[0];
-		message.boneMatrices[i][1] = boneMat.data()[1];
-		message.boneMatrices[i][2] = boneMat.data()[2];
-		message.boneMatrices[i][3] = boneMat.data()[3];
-		message.boneMatrices[i][4] = boneMat.data()[4];
-		message.boneMatrices[i][5] = boneMat.data()[5];
-		message.boneMatrices[i][6] = boneMat.data()[6];
-		message.boneMatrices[i][7] = boneMat.data()[7];
-		message.boneMatrices[i][8] = boneMat.data()[8];
-		message.boneMatrices[i][9] = boneMat.data()[9];
-		message.boneMatrices[i][10] = boneMat.data()[10];
-		message.boneMatrices[i][11] = boneMat.data()[11];
-		message.boneMatrices[i][12] = boneMat.data()[12];
-		message.boneMatrices[i][13] = boneMat.data()[13];
-		message.boneMatrices[i][14] = boneMat.data()[14];
-		message.boneMatrices[i][15] = boneMat.data()[15];
-	}
-	
+	for (size_t i = 0; i < 16; i++)
+		message.matrix[i] = mat.data()[i];
+
+	message.boneCount = changedBoneCount;
+	memcpy(message.data, changedBones, changedBoneCount * sizeof(MsgSonicUpdate::Bone));
+
 	s_messageSender.endMessage();
 }
 
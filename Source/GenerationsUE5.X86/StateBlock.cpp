@@ -0,0 +1,81 @@
+#include "StateBlock.h"
+
+#include "BaseTexture.h"
+#include "Device.h"
+
+StateBlock::StateBlock(Device* device) : m_device(device)
+{
+}
+
+void StateBlock::setRenderState(D3DRENDERSTATETYPE state, DWORD value)
+{
+    assert(state < 210);
+
+    m_renderStateMask.set(state);
+    m_renderStates[state] = value;
+}
+
+void StateBlock::setSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value)
+{
+    assert(sampler < 16 && type < 14);
+
+    m_samplerStateMask.set(sampler * 14 + type);
+    m_samplerStates[sampler][type] = value;
+}
+
+void StateBlock::setTexture(DWORD stage, BaseTexture* texture)
+{
+    assert(stage < 16);
+
+    m_textureMask.set(stage);
+    m_textures[stage] = texture;
+}
+
+bool StateBlock::hasRenderState(D3DRENDERSTATETYPE state) const
+{
+    return m_renderStateMask.test(state);
+}
+
+DWORD StateBlock::getRenderState(D3DRENDERSTATETYPE state) const
+{
+    return m_renderStates[state];
+}
+
+bool StateBlock::hasSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type) const
+{
+    return m_samplerStateMask.test(sampler * 14 + type);
+}
+
+DWORD StateBlock::getSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type) const
+{
+    return m_samplerStates[sampler][type];
+}
+
+bool StateBlock::hasTexture(DWORD stage) const
+{
+    return m_textureMask.test(stage);
+}
+
+BaseTexture* StateBlock::getTexture(DWORD stage) const
+{
+    return m_textures[stage].Get();
+}
+
+HRESULT StateBlock::GetDevice(Device** ppDevice)
+{
+    m_device->AddRef();
+    *ppDevice = m_device;
+    return S_OK;
+}
+
+HRESULT StateBlock::Capture()
+{
+    m_device->captureStateBlock(*this);
+    return S_OK;
+}
+
+HRESULT StateBlock::Apply()
+{
+    m_device->applyStateBlock(*this);
+    return S_OK;
+}
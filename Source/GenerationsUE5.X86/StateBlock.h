@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Unknown.h"
+
+#include <bitset>
+
+class BaseTexture;
+class Device;
+
+// Holds the render, sampler and texture states that were recorded or captured
+// into it. Applying a state block sends only the states that differ from the
+// ones currently set on the device, as a single message.
+class StateBlock : public Unknown
+{
+protected:
+    Device* m_device;
+
+    std::bitset<210> m_renderStateMask;
+    DWORD m_renderStates[210]{};
+
+    std::bitset<16 * 14> m_samplerStateMask;
+    DWORD m_samplerStates[16][14]{};
+
+    std::bitset<16> m_textureMask;
+    ComPtr<BaseTexture> m_textures[16];
+
+public:
+    explicit StateBlock(Device* device);
+
+    void setRenderState(D3DRENDERSTATETYPE state, DWORD value);
+    void setSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type, DWORD value);
+    void setTexture(DWORD stage, BaseTexture* texture);
+
+    bool hasRenderState(D3DRENDERSTATETYPE state) const;
+    DWORD getRenderState(D3DRENDERSTATETYPE state) const;
+
+    bool hasSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type) const;
+    DWORD getSamplerState(DWORD sampler, D3DSAMPLERSTATETYPE type) const;
+
+    bool hasTexture(DWORD stage) const;
+    BaseTexture* getTexture(DWORD stage) const;
+
+    virtual HRESULT GetDevice(Device** ppDevice) final;
+    virtual HRESULT Capture() final;
+    virtual HRESULT Apply() final;
+};
@@ -34,9 +34,15 @@ HRESULT Surface::GetDesc(D3DSURFACE_DESC* pDesc)
     return S_OK;
 }
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Surface::LockRect, D3DLOCKED_RECT* pLockedRect, const RECT* pRect, DWORD Flags)
+HRESULT Surface::LockRect(D3DLOCKED_RECT* pLockedRect, const RECT* pRect, DWORD Flags)
+{
+    return m_texture->LockRect(m_level, pLockedRect, pRect, Flags);
+}
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Surface::UnlockRect)
+HRESULT Surface::UnlockRect()
+{
+    return m_texture->UnlockRect(m_level);
+}
 
 FUNCTION_STUB(HRESULT, E_NOTIMPL, Surface::GetDC, HDC* phdc)
 
@@ -1,11 +1,66 @@
 #include "Texture.h"
 
+#include "AlignmentUtil.h"
 #include "Message.h"
 #include "MessageSender.h"
 #include "Surface.h"
 
-Texture::Texture(uint32_t width, uint32_t height, uint32_t levelCount)
-    : BaseTexture(levelCount), m_width(width), m_height(height)
+struct FormatInfo
+{
+    uint32_t blockSize;
+    uint32_t bytesPerBlock;
+};
+
+static FormatInfo getFormatInfo(D3DFORMAT format)
+{
+    switch (static_cast<uint32_t>(format))
+    {
+    case D3DFMT_DXT1:
+    case MAKEFOURCC('A', 'T', 'I', '1'):
+        return { 4, 8 };
+
+    case D3DFMT_DXT2:
+    case D3DFMT_DXT3:
+    case D3DFMT_DXT4:
+    case D3DFMT_DXT5:
+    case MAKEFOURCC('A', 'T', 'I', '2'):
+        return { 4, 16 };
+
+    case D3DFMT_A8:
+    case D3DFMT_L8:
+        return { 1, 1 };
+
+    case D3DFMT_R5G6B5:
+    case D3DFMT_X1R5G5B5:
+    case D3DFMT_A1R5G5B5:
+    case D3DFMT_A4R4G4B4:
+    case D3DFMT_A8L8:
+    case D3DFMT_L16:
+    case D3DFMT_R16F:
+    case D3DFMT_D16:
+        return { 1, 2 };
+
+    case D3DFMT_A16B16G16R16:
+    case D3DFMT_A16B16G16R16F:
+    case D3DFMT_G32R32F:
+        return { 1, 8 };
+
+    case D3DFMT_A32B32G32R32F:
+        return { 1, 16 };
+
+    default:
+        return { 1, 4 };
+    }
+}
+
+// The bridge expects rows to be at least 256 bytes apart
+static uint32_t computeUploadPitch(uint32_t rowSize)
+{
+    return std::max(rowSize, 256u);
+}
+
+Texture::Texture(uint32_t width, uint32_t height, uint32_t levelCount, D3DFORMAT format)
+    : BaseTexture(levelCount), m_width(width), m_height(height), m_format(format)
 {
 }
 
@@ -21,6 +76,11 @@ uint32_t Texture::getHeight() const
     return m_height;
 }
 
+D3DFORMAT Texture::getFormat() const
+{
+    return m_format;
+}
+
 Surface* Texture::getSurface(size_t index)
 {
     if (!m_surfaces[index])
@@ -58,23 +118,87 @@ HRESULT Texture::GetSurfaceLevel(UINT Level, Surface** ppSurfaceLevel)
     return S_OK;
 }
 
-HRESULT Texture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const RECT* pRect, DWORD Flags)
+uint8_t* Texture::beginWrite(uint32_t level, const RECT& rect, uint32_t& pitch)
 {
-    // TODO: is it safe to assume RGBA8 here??
+    const auto formatInfo = getFormatInfo(m_format);
+    const uint32_t width = std::max(m_width >> level, 1u);
+    const uint32_t height = std::max(m_height >> level, 1u);
+
+    const uint32_t regionWidth = static_cast<uint32_t>(rect.right - rect.left);
+    const uint32_t regionHeight = static_cast<uint32_t>(rect.bottom - rect.top);
+    const uint32_t blockRowCount = (regionHeight + formatInfo.blockSize - 1) / formatInfo.blockSize;
+
+    pitch = computeUploadPitch((regionWidth + formatInfo.blockSize - 1) / formatInfo.blockSize * formatInfo.bytesPerBlock);
+
+    if (rect.left == 0 && rect.top == 0 && regionWidth == width && regionHeight == height)
+    {
+        auto& message = s_messageSender.makeMessage<MsgWriteTexture>(pitch * blockRowCount);
 
-    const uint32_t width = m_width >> Level;
-    const uint32_t height = m_height >> Level;
-    const uint32_t pitch = std::max(width * 4u, 256u);
+        message.textureId = m_id;
+        message.width = width;
+        message.height = height;
+        message.level = level;
+        message.pitch = pitch;
 
-    auto& message = s_messageSender.makeMessage<MsgWriteTexture>(pitch * height);
+        return message.data;
+    }
+
+    auto& message = s_messageSender.makeMessage<MsgWriteTextureRegion>(pitch * blockRowCount);
 
     message.textureId = m_id;
-    message.width = width;
-    message.height = height;
-    message.level = Level;
+    message.level = level;
+    message.x = static_cast<uint32_t>(rect.left);
+    message.y = static_cast<uint32_t>(rect.top);
+    message.width = regionWidth;
+    message.height = regionHeight;
     message.pitch = pitch;
 
-    pLockedRect->pBits = message.data;
+    return message.data;
+}
+
+// Clamps the rectangle to the level and expands it to block boundaries
+static RECT computeLockRect(const RECT* pRect, uint32_t width, uint32_t height, uint32_t blockSize)
+{
+    if (pRect == nullptr)
+        return { 0, 0, static_cast<LONG>(width), static_cast<LONG>(height) };
+
+    RECT rect;
+    rect.left = static_cast<LONG>(alignDown(std::min<uint32_t>(std::max<LONG>(pRect->left, 0), width), blockSize));
+    rect.top = static_cast<LONG>(alignDown(std::min<uint32_t>(std::max<LONG>(pRect->top, 0), height), blockSize));
+    rect.right = static_cast<LONG>(std::min(alignUp<uint32_t>(std::max<LONG>(pRect->right, rect.left), blockSize), width));
+    rect.bottom = static_cast<LONG>(std::min(alignUp<uint32_t>(std::max<LONG>(pRect->bottom, rect.top), blockSize), height));
+
+    return rect;
+}
+
+HRESULT Texture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const RECT* pRect, DWORD Flags)
+{
+    const auto formatInfo = getFormatInfo(m_format);
+    const uint32_t width = std::max(m_width >> Level, 1u);
+    const uint32_t height = std::max(m_height >> Level, 1u);
+
+    const RECT rect = computeLockRect(pRect, width, height, formatInfo.blockSize);
+
+    if (Flags & D3DLOCK_NO_DIRTY_UPDATE)
+    {
+        const uint32_t pitch = (width + formatInfo.blockSize - 1) / formatInfo.blockSize * formatInfo.bytesPerBlock;
+
+        if (!m_shadowLevels[Level])
+            m_shadowLevels[Level] = std::make_unique<uint8_t[]>(pitch * ((height + formatInfo.blockSize - 1) / formatInfo.blockSize));
+
+        pLockedRect->pBits = m_shadowLevels[Level].get() +
+            rect.top / formatInfo.blockSize * pitch + rect.left / formatInfo.blockSize * formatInfo.bytesPerBlock;
+
+        pLockedRect->Pitch = pitch;
+
+        m_shadowLockMask |= 1 << Level;
+        m_shadowWriteMask |= 1 << Level;
+
+        return S_OK;
+    }
+
+    uint32_t pitch = 0;
+    pLockedRect->pBits = beginWrite(Level, rect, pitch);
     pLockedRect->Pitch = pitch;
 
     return S_OK;
@@ -82,12 +206,61 @@ HRESULT Texture::LockRect(UINT Level, D3DLOCKED_RECT* pLockedRect, const RECT* p
 
 HRESULT Texture::UnlockRect(UINT Level)
 {
-    s_messageSender.endMessage();
+    // Uploaded later by AddDirtyRect
+    if (m_shadowLockMask & (1 << Level))
+        m_shadowLockMask &= ~(1 << Level);
+    else
+        s_messageSender.endMessage();
 
     return S_OK;
 }
 
-FUNCTION_STUB(HRESULT, E_NOTIMPL, Texture::AddDirtyRect, const RECT* pDirtyRect)
+HRESULT Texture::AddDirtyRect(const RECT* pDirtyRect)
+{
+    const auto formatInfo = getFormatInfo(m_format);
+
+    for (uint32_t level = 0; level < _countof(m_shadowLevels); level++)
+    {
+        if (!(m_shadowWriteMask & (1 << level)))
+            continue;
+
+        const uint32_t width = std::max(m_width >> level, 1u);
+        const uint32_t height = std::max(m_height >> level, 1u);
+
+        // Dirty rectangles are specified for the top level, scale them down and round outwards for mips
+        RECT levelRect;
+        if (pDirtyRect != nullptr)
+        {
+            levelRect.left = pDirtyRect->left >> level;
+            levelRect.top = pDirtyRect->top >> level;
+            levelRect.right = (pDirtyRect->right + (1 << level) - 1) >> level;
+            levelRect.bottom = (pDirtyRect->bottom + (1 << level) - 1) >> level;
+        }
+
+        const RECT rect = computeLockRect(pDirtyRect != nullptr ? &levelRect : nullptr, width, height, formatInfo.blockSize);
+        if (rect.right <= rect.left || rect.bottom <= rect.top)
+            continue;
+
+        const uint32_t shadowPitch = (width + formatInfo.blockSize - 1) / formatInfo.blockSize * formatInfo.bytesPerBlock;
+        const uint32_t rowSize = (rect.right - rect.left + formatInfo.blockSize - 1) / formatInfo.blockSize * formatInfo.bytesPerBlock;
+        const uint32_t rowCount = (rect.bottom - rect.top + formatInfo.blockSize - 1) / formatInfo.blockSize;
+
+        const uint8_t* srcData = m_shadowLevels[level].get() +
+            rect.top / formatInfo.blockSize * shadowPitch + rect.left / formatInfo.blockSize * formatInfo.bytesPerBlock;
+
+        uint32_t pitch = 0;
+        uint8_t* dstData = beginWrite(level, rect, pitch);
+
+        for (uint32_t i = 0; i < rowCount; i++)
+            memcpy(dstData + i * pitch, srcData + i * shadowPitch, rowSize);
+
+        s_messageSender.endMessage();
+    }
+
+    m_shadowWriteMask = 0;
+
+    return S_OK;
+}
 
 HRESULT Texture::BeginSfdDecodeCallback(uintptr_t, Texture*& texture, uintptr_t, uintptr_t)
 {
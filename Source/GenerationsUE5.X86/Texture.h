@@ -9,14 +9,24 @@ class Texture : public BaseTexture
 protected:
     uint32_t m_width;
     uint32_t m_height;
+    D3DFORMAT m_format;
     ComPtr<Surface> m_surfaces[15];
 
+    // Levels locked with D3DLOCK_NO_DIRTY_UPDATE get written to a CPU copy,
+    // which gets uploaded in the regions passed to AddDirtyRect.
+    std::unique_ptr<uint8_t[]> m_shadowLevels[15];
+    uint32_t m_shadowLockMask = 0;
+    uint32_t m_shadowWriteMask = 0;
+
+    uint8_t* beginWrite(uint32_t level, const RECT& rect, uint32_t& pitch);
+
 public:
-    explicit Texture(uint32_t width, uint32_t height, uint32_t levelCount);
+    explicit Texture(uint32_t width, uint32_t height, uint32_t levelCount, D3DFORMAT format = D3DFMT_A8R8G8B8);
     ~Texture() override;
 
     uint32_t getWidth() const;
     uint32_t getHeight() const;
+    D3DFORMAT getFormat() const;
     Surface* getSurface(size_t index);
 
     void setResolution(uint32_t width, uint32_t height);
@@ -0,0 +1,72 @@
+#include "TransientRing.h"
+
+#include "MessageSender.h"
+
+void TransientRing::init(uint32_t capacity)
+{
+    assert((capacity & (capacity - 1)) == 0);
+
+    m_capacity = capacity;
+    m_head = 0;
+    m_tail = 0;
+    m_batches.clear();
+}
+
+bool TransientRing::isEnabled() const
+{
+    return m_capacity != 0;
+}
+
+uint32_t TransientRing::getCapacity() const
+{
+    return m_capacity;
+}
+
+void TransientRing::reclaim(uint32_t commitIndex)
+{
+    while (!m_batches.empty() && static_cast<int32_t>(commitIndex - m_batches.front().commitIndex) >= static_cast<int32_t>(s_batchLatency))
+    {
+        m_tail = m_batches.front().cursor;
+        m_batches.pop_front();
+    }
+}
+
+bool TransientRing::allocate(uint32_t byteSize, uint32_t alignment, uint32_t& offset)
+{
+    if (byteSize > m_capacity)
+        return false;
+
+    const uint32_t commitIndex = s_messageSender.getCommitIndex();
+    reclaim(commitIndex);
+
+    // Allocations never wrap around the end of the buffer
+    uint32_t begin = m_head;
+    uint32_t beginOffset = begin & (m_capacity - 1);
+
+    const uint32_t remainder = beginOffset % alignment;
+    if (remainder != 0)
+    {
+        begin += alignment - remainder;
+        beginOffset += alignment - remainder;
+    }
+
+    if (beginOffset + byteSize > m_capacity)
+    {
+        begin += m_capacity - beginOffset;
+        beginOffset = 0;
+    }
+
+    const uint32_t end = begin + byteSize;
+    if (end - m_tail > m_capacity)
+        return false;
+
+    if (m_batches.empty() || m_batches.back().commitIndex != commitIndex)
+        m_batches.push_back({ commitIndex, end });
+    else
+        m_batches.back().cursor = end;
+
+    m_head = end;
+    offset = beginOffset;
+
+    return true;
+}
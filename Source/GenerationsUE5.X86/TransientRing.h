@@ -0,0 +1,37 @@
+#pragma once
+
+#include <deque>
+
+// Suballocates a persistent buffer for data that only lives for a frame.
+// Space gets reclaimed once the batches that used it are old enough for the
+// bridge to be done with them.
+class TransientRing
+{
+protected:
+    // One extra batch for allocations that end up in the batch after the one they were made in
+    static constexpr uint32_t s_batchLatency = 3;
+
+    struct Batch
+    {
+        uint32_t commitIndex;
+        uint32_t cursor;
+    };
+
+    uint32_t m_capacity = 0;
+    uint32_t m_head = 0;
+    uint32_t m_tail = 0;
+    std::deque<Batch> m_batches;
+
+    void reclaim(uint32_t commitIndex);
+
+public:
+    // Capacity needs to be a power of two
+    void init(uint32_t capacity);
+
+    bool isEnabled() const;
+    uint32_t getCapacity() const;
+
+    // Doesn't block, fails if there is not enough space left for this frame.
+    // The offset is a multiple of the alignment, which doesn't need to be a power of two.
+    bool allocate(uint32_t byteSize, uint32_t alignment, uint32_t& offset);
+};
@@ -76,12 +76,7 @@ void UpReelRenderable::createInstanceAndBottomLevelAccelStruct(Sonic::CObjUpReel
         if (initialWrite)
         {
             reelRendererEx->m_vertexBuffer.Attach(new VertexBuffer(vertexByteSize));
-
-            auto& createMsg = s_messageSender.makeMessage<MsgCreateVertexBuffer>();
-            createMsg.vertexBufferId = reelRendererEx->m_vertexBuffer->getId();
-            createMsg.length = vertexByteSize;
-            createMsg.allowUnorderedAccess = false;
-            s_messageSender.endMessage();
+            reelRendererEx->m_vertexBuffer->create(false);
         }
 
         auto& writeMsg = s_messageSender.makeMessage<MsgWriteVertexBuffer>(vertexByteSize);
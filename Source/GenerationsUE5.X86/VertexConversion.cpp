@@ -0,0 +1,180 @@
+#include "VertexConversion.h"
+
+#include <intrin.h>
+#include <smmintrin.h>
+
+static bool checkSimdSupport()
+{
+    int cpuInfo[4]{};
+    __cpuid(cpuInfo, 1);
+
+    // SSSE3 and SSE4.1
+    return (cpuInfo[2] & (1 << 9)) != 0 && (cpuInfo[2] & (1 << 19)) != 0;
+}
+
+static const bool s_simdSupported = checkSimdSupport();
+
+bool VertexConversion::isSimdSupported()
+{
+    return s_simdSupported;
+}
+
+// Loads a 32-bit value from each of the four vertices and swaps its bytes
+static __m128i gather32(const uint8_t* source, uint32_t stride)
+{
+    const __m128i swapMask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    uint32_t values[4];
+    for (size_t i = 0; i < 4; i++)
+        memcpy(&values[i], source + i * stride, sizeof(uint32_t));
+
+    return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(values)), swapMask);
+}
+
+static void scatter32(uint8_t* destination, uint32_t stride, __m128i value)
+{
+    uint32_t values[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(values), value);
+
+    for (size_t i = 0; i < 4; i++)
+        memcpy(destination + i * stride, &values[i], sizeof(uint32_t));
+}
+
+// Same as quantizeUnorm(value * 0.5f + 0.5f, 10)
+static __m128i quantizeSnorm10x4(__m128 value)
+{
+    value = _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(0.5f)), _mm_set1_ps(0.5f));
+
+    // Written the same way as the scalar version so that NaN ends up as zero
+    value = _mm_and_ps(value, _mm_cmpge_ps(value, _mm_setzero_ps()));
+    value = _mm_blendv_ps(_mm_set1_ps(1.0f), value, _mm_cmple_ps(value, _mm_set1_ps(1.0f)));
+
+    return _mm_and_si128(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(1023.0f)), _mm_set1_ps(0.5f))), _mm_set1_epi32(0x3FF));
+}
+
+static void convertFloat3ToUdec3n(const uint8_t* source, uint32_t sourceStride, uint8_t* destination, uint32_t destinationStride)
+{
+    const __m128 x = _mm_castsi128_ps(gather32(source, sourceStride));
+    const __m128 y = _mm_castsi128_ps(gather32(source + 4, sourceStride));
+    const __m128 z = _mm_castsi128_ps(gather32(source + 8, sourceStride));
+
+    // Summed in the same order as Eigen, vectors of zero length are left as is
+    const __m128 squaredNorm = _mm_add_ps(_mm_mul_ps(x, x), _mm_add_ps(_mm_mul_ps(y, y), _mm_mul_ps(z, z)));
+    const __m128 norm = _mm_sqrt_ps(squaredNorm);
+    const __m128 mask = _mm_cmpgt_ps(squaredNorm, _mm_setzero_ps());
+
+    const __m128i quantizedX = quantizeSnorm10x4(_mm_blendv_ps(x, _mm_div_ps(x, norm), mask));
+    const __m128i quantizedY = quantizeSnorm10x4(_mm_blendv_ps(y, _mm_div_ps(y, norm), mask));
+    const __m128i quantizedZ = quantizeSnorm10x4(_mm_blendv_ps(z, _mm_div_ps(z, norm), mask));
+
+    scatter32(destination, destinationStride,
+        _mm_or_si128(quantizedX, _mm_or_si128(_mm_slli_epi32(quantizedY, 10), _mm_slli_epi32(quantizedZ, 20))));
+}
+
+static __m128i dec3nToUdec3nx4(__m128i value)
+{
+    const __m128i signExtend = _mm_or_si128(_mm_slli_epi32(value, 22), value);
+    return _mm_and_si128(_mm_add_epi32(signExtend, _mm_set1_epi32(511)), _mm_set1_epi32(0x3FF));
+}
+
+static void convertDec3nToUdec3n(const uint8_t* source, uint32_t sourceStride, uint8_t* destination, uint32_t destinationStride)
+{
+    const __m128i value = gather32(source, sourceStride);
+    const __m128i mask = _mm_set1_epi32(0x3FF);
+
+    scatter32(destination, destinationStride, _mm_or_si128(
+        dec3nToUdec3nx4(_mm_and_si128(value, mask)), _mm_or_si128(
+        _mm_slli_epi32(dec3nToUdec3nx4(_mm_and_si128(_mm_srli_epi32(value, 10), mask)), 10),
+        _mm_slli_epi32(dec3nToUdec3nx4(_mm_and_si128(_mm_srli_epi32(value, 20), mask)), 20))));
+}
+
+// Integer version of quantizeHalf. F16C rounds to nearest even and keeps
+// denormals, which doesn't match the scalar version.
+static __m128i quantizeHalfx4(__m128i value)
+{
+    const __m128i sign = _mm_and_si128(_mm_srli_epi32(value, 16), _mm_set1_epi32(0x8000));
+    const __m128i exponentMantissa = _mm_and_si128(value, _mm_set1_epi32(0x7FFFFFFF));
+
+    __m128i half = _mm_srai_epi32(_mm_add_epi32(exponentMantissa, _mm_set1_epi32((1 << 12) - (112 << 23))), 13);
+    half = _mm_andnot_si128(_mm_cmplt_epi32(exponentMantissa, _mm_set1_epi32(113 << 23)), half);
+    half = _mm_blendv_epi8(half, _mm_set1_epi32(0x7C00), _mm_cmpgt_epi32(exponentMantissa, _mm_set1_epi32((143 << 23) - 1)));
+    half = _mm_blendv_epi8(half, _mm_set1_epi32(0x7E00), _mm_cmpgt_epi32(exponentMantissa, _mm_set1_epi32(255 << 23)));
+
+    return _mm_or_si128(sign, half);
+}
+
+static void convertFloat2ToHalf2(const uint8_t* source, uint32_t sourceStride, uint8_t* destination, uint32_t destinationStride)
+{
+    const __m128i x = quantizeHalfx4(gather32(source, sourceStride));
+    const __m128i y = quantizeHalfx4(gather32(source + 4, sourceStride));
+
+    scatter32(destination, destinationStride, _mm_or_si128(x, _mm_slli_epi32(y, 16)));
+}
+
+void VertexConversion::convertSimd(VertexConversionType type, const VertexStream& stream)
+{
+    void (*kernel)(const uint8_t*, uint32_t, uint8_t*, uint32_t) = nullptr;
+
+    switch (type)
+    {
+    case VertexConversionType::Float3ToUdec3n:
+        kernel = convertFloat3ToUdec3n;
+        break;
+
+    case VertexConversionType::Dec3nToUdec3n:
+        kernel = convertDec3nToUdec3n;
+        break;
+
+    case VertexConversionType::Float2ToHalf2:
+        kernel = convertFloat2ToHalf2;
+        break;
+    }
+
+    // Plain byte swaps are bound by the strided loads, there is nothing to gain
+    if (kernel == nullptr)
+    {
+        MeshConversion::convertScalar(type, stream);
+        return;
+    }
+
+    const uint32_t simdCount = stream.count & ~3u;
+
+    for (uint32_t i = 0; i < simdCount; i += 4)
+        kernel(stream.source + i * stream.sourceStride, stream.sourceStride, stream.destination + i * stream.destinationStride, stream.destinationStride);
+
+    MeshConversion::convertScalar(type, { stream.source + simdCount * stream.sourceStride, stream.sourceStride,
+        stream.destination + simdCount * stream.destinationStride, stream.destinationStride, stream.count - simdCount });
+}
+
+void VertexConversion::convert(VertexConversionType type, const VertexStream& stream)
+{
+    if (type == VertexConversionType::None)
+        return;
+
+    if (s_simdSupported)
+        convertSimd(type, stream);
+    else
+        MeshConversion::convertScalar(type, stream);
+}
+
+void VertexConversion::byteSwap32Simd(uint8_t* destination, const uint8_t* source, size_t byteSize)
+{
+    const __m128i swapMask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const size_t simdSize = byteSize & ~static_cast<size_t>(15);
+
+    for (size_t i = 0; i < simdSize; i += 16)
+    {
+        const __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), _mm_shuffle_epi8(value, swapMask));
+    }
+
+    MeshConversion::byteSwap32Scalar(destination + simdSize, source + simdSize, byteSize - simdSize);
+}
+
+void VertexConversion::byteSwap32(uint8_t* destination, const uint8_t* source, size_t byteSize)
+{
+    if (s_simdSupported)
+        byteSwap32Simd(destination, source, byteSize);
+    else
+        MeshConversion::byteSwap32Scalar(destination, source, byteSize);
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "MeshConversion.h"
+
+// Conversions from the big-endian vertex elements of mesh resources to the
+// little-endian optimized vertex format, one element over a run of vertices.
+struct VertexConversion
+{
+    // The SSE4.1 kernels produce the exact same output as the scalar reference
+    // in MeshConversion, they get used whenever the CPU supports them.
+    static bool isSimdSupported();
+
+    static void convertSimd(VertexConversionType type, const VertexStream& stream);
+    static void convert(VertexConversionType type, const VertexStream& stream);
+
+    static void byteSwap32Simd(uint8_t* destination, const uint8_t* source, size_t byteSize);
+    static void byteSwap32(uint8_t* destination, const uint8_t* source, size_t byteSize);
+};
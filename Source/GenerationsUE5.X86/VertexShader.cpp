@@ -1,11 +1,18 @@
 #include "VertexShader.h"
 
+#include "ShaderCache.h"
+
 static std::atomic<uint32_t> s_curId = 0;
 
 VertexShader::VertexShader() : m_id(++s_curId)
 {
 }
 
+VertexShader::~VertexShader()
+{
+    ShaderCache::releaseVertexShader(m_id);
+}
+
 uint32_t VertexShader::getId() const
 {
     return m_id;
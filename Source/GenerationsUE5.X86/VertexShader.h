@@ -11,6 +11,7 @@ protected:
 
 public:
     VertexShader();
+    ~VertexShader() override;
 
     uint32_t getId() const;
 
@@ -106,12 +106,7 @@ void WallJumpBlock::createInstanceAndBottomLevelAccelStruct(Sonic::CObjWallJumpB
     if (initialWrite)
     {
         wallJumpBlockRenderEx->m_vertexBuffer.Attach(new VertexBuffer(vertexByteSize));
-
-        auto& createMsg = s_messageSender.makeMessage<MsgCreateVertexBuffer>();
-        createMsg.vertexBufferId = wallJumpBlockRenderEx->m_vertexBuffer->getId();
-        createMsg.length = vertexByteSize;
-        createMsg.allowUnorderedAccess = false;
-        s_messageSender.endMessage();
+        wallJumpBlockRenderEx->m_vertexBuffer->create(false);
     }
 
     const XXH32_hash_t vertexHash = XXH32(wallJumpBlockRender->m_aPanelVertexData,
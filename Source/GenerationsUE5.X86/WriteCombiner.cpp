@@ -0,0 +1,93 @@
+#include "WriteCombiner.h"
+
+#include "LockGuard.h"
+
+WriteCombiner::WriteCombiner(uint32_t id, uint32_t byteSize, SendFunction sendFunction)
+    : m_id(id), m_sendFunction(sendFunction), m_data(std::make_unique<uint8_t[]>(byteSize))
+{
+}
+
+WriteCombiner::~WriteCombiner()
+{
+    // Pending ranges get dropped, the buffer is going away anyway
+    if (m_pending)
+    {
+        LockGuard lock(s_mutex);
+        s_pending.erase(std::find(s_pending.begin(), s_pending.end(), this));
+    }
+}
+
+void WriteCombiner::addRange(uint32_t begin, uint32_t end)
+{
+    // Ranges are sorted and never touch each other, find the first one that
+    // overlaps or is adjacent to the new range and absorb everything up to the last
+    auto first = std::lower_bound(m_ranges.begin(), m_ranges.end(), begin,
+        [](const Range& range, uint32_t value) { return range.end < value; });
+
+    auto last = first;
+    while (last != m_ranges.end() && last->begin <= end)
+    {
+        begin = std::min(begin, last->begin);
+        end = std::max(end, last->end);
+        ++last;
+    }
+
+    if (first == last)
+    {
+        m_ranges.insert(first, { begin, end });
+    }
+    else
+    {
+        *first = { begin, end };
+        m_ranges.erase(first + 1, last);
+    }
+}
+
+void WriteCombiner::send()
+{
+    for (const auto& range : m_ranges)
+        m_sendFunction(m_id, range.begin, m_data.get() + range.begin, range.end - range.begin);
+
+    m_ranges.clear();
+    m_pending = false;
+}
+
+uint8_t* WriteCombiner::lock(uint32_t offset, uint32_t byteSize)
+{
+    LockGuard lock(s_mutex);
+
+    // The range only gets sent after unlock, otherwise a flush could send it half written and drop it
+    m_lockedRanges.push_back({ offset, offset + byteSize });
+
+    return m_data.get() + offset;
+}
+
+void WriteCombiner::unlock()
+{
+    LockGuard lock(s_mutex);
+
+    if (m_lockedRanges.empty())
+        return;
+
+    const Range range = m_lockedRanges.front();
+    m_lockedRanges.erase(m_lockedRanges.begin());
+
+    if (range.begin != range.end)
+        addRange(range.begin, range.end);
+
+    if (!m_pending && !m_ranges.empty())
+    {
+        s_pending.push_back(this);
+        m_pending = true;
+    }
+}
+
+void WriteCombiner::flush()
+{
+    LockGuard lock(s_mutex);
+
+    for (const auto writeCombiner : s_pending)
+        writeCombiner->send();
+
+    s_pending.clear();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Mutex.h"
+
+// Staging copy for buffers that get locked again after their initial write.
+// Locks land in the copy and record the written range on unlock, overlapping and
+// adjacent ranges get merged and sent once something might read the buffer.
+// Ranges are only touched under the global mutex, loading threads lock buffers
+// while the render thread flushes.
+class WriteCombiner
+{
+public:
+    using SendFunction = void(*)(uint32_t id, uint32_t offset, const uint8_t* data, uint32_t byteSize);
+
+protected:
+    static inline Mutex s_mutex;
+    static inline std::vector<WriteCombiner*> s_pending;
+
+    struct Range
+    {
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    uint32_t m_id;
+    SendFunction m_sendFunction;
+    std::unique_ptr<uint8_t[]> m_data;
+    std::vector<Range> m_ranges;
+    std::vector<Range> m_lockedRanges;
+    bool m_pending = false;
+
+    void addRange(uint32_t begin, uint32_t end);
+    void send();
+
+public:
+    WriteCombiner(uint32_t id, uint32_t byteSize, SendFunction sendFunction);
+    ~WriteCombiner();
+
+    uint8_t* lock(uint32_t offset, uint32_t byteSize);
+    void unlock();
+
+    // Sends the merged ranges of every buffer written since the last flush,
+    // needs to happen before anything that reads buffers gets sent.
+    static void flush();
+};